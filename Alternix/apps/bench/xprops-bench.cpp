@@ -0,0 +1,171 @@
+// Micro-benchmark for osm-running's window property fetch.
+//
+// Creates N client windows carrying the same properties osm-running reads
+// (_NET_WM_NAME, WM_NAME, WM_CLASS and a multi-size _NET_WM_ICON), then
+// times the old per-window blocking Xlib sequence against the pipelined
+// xcb fetch used by SidePanel::refreshWindows.
+//
+//   g++ -O2 apps/bench/xprops-bench.cpp -o xprops-bench -lX11 -lX11-xcb -lxcb
+//   Xvfb :99 -screen 0 1080x2340x24 &
+//   DISPLAY=:99 ./xprops-bench 20 200
+//
+// Args: window count (default 20), iterations (default 200).
+// For a slow-link comparison point DISPLAY at a TCP display
+// (Xvfb -listen tcp, DISPLAY=localhost:99) shaped with `tc qdisc ... netem`.
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Atoms {
+    Atom netWmName, netWmIcon, utf8;
+};
+
+static std::vector<Window> makeClients(Display *dpy, const Atoms &a, int n) {
+    std::vector<Window> out;
+    Window root = DefaultRootWindow(dpy);
+
+    // 16, 48 and 256 px icons, like a typical browser sets
+    std::vector<unsigned long> icon;
+    for (int sz : { 16, 48, 256 }) {
+        icon.push_back(sz);
+        icon.push_back(sz);
+        for (int i = 0; i < sz * sz; i++)
+            icon.push_back(0xff000000UL | (unsigned long)(i * 2654435761U >> 8));
+    }
+
+    for (int i = 0; i < n; i++) {
+        Window w = XCreateSimpleWindow(dpy, root, 0, 0, 64, 64, 0, 0, 0);
+
+        char title[64];
+        snprintf(title, sizeof(title), "Bench window %d — some page title", i);
+        XChangeProperty(dpy, w, a.netWmName, a.utf8, 8, PropModeReplace,
+                        (unsigned char*)title, strlen(title));
+        XStoreName(dpy, w, title);
+
+        XClassHint hint;
+        hint.res_name  = (char*)"bench";
+        hint.res_class = (char*)"Bench";
+        XSetClassHint(dpy, w, &hint);
+
+        XChangeProperty(dpy, w, a.netWmIcon, XA_CARDINAL, 32, PropModeReplace,
+                        (unsigned char*)icon.data(), icon.size());
+        out.push_back(w);
+    }
+    XSync(dpy, False);
+    return out;
+}
+
+// What osm-running did before: 4 blocking round trips per window
+static size_t fetchXlib(Display *dpy, const Atoms &a, const std::vector<Window> &wins) {
+    size_t bytes = 0;
+    for (Window w : wins) {
+        Atom type; int format; unsigned long n, after;
+        unsigned char *data = nullptr;
+
+        if (XGetWindowProperty(dpy, w, a.netWmName, 0, (~0L), False, a.utf8,
+                               &type, &format, &n, &after, &data) == Success && data) {
+            bytes += n;
+            XFree(data);
+        }
+
+        XTextProperty tp;
+        if (XGetWMName(dpy, w, &tp) && tp.value) {
+            bytes += tp.nitems;
+            XFree(tp.value);
+        }
+
+        XClassHint hint;
+        if (XGetClassHint(dpy, w, &hint)) {
+            bytes += strlen(hint.res_class);
+            XFree(hint.res_name);
+            XFree(hint.res_class);
+        }
+
+        data = nullptr;
+        if (XGetWindowProperty(dpy, w, a.netWmIcon, 0, (~0L), False, AnyPropertyType,
+                               &type, &format, &n, &after, &data) == Success && data) {
+            bytes += n * 4;
+            XFree(data);
+        }
+    }
+    return bytes;
+}
+
+// What SidePanel::refreshWindows does now: issue everything, then collect
+static size_t fetchXcb(Display *dpy, const Atoms &a, const std::vector<Window> &wins) {
+    xcb_connection_t *c = XGetXCBConnection(dpy);
+    std::vector<xcb_get_property_cookie_t> ck;
+    ck.reserve(wins.size() * 4);
+
+    for (Window w : wins) {
+        ck.push_back(xcb_get_property(c, 0, w, a.netWmName, a.utf8, 0, 1024));
+        ck.push_back(xcb_get_property(c, 0, w, XA_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 0, 1024));
+        ck.push_back(xcb_get_property(c, 0, w, XA_WM_CLASS, XA_STRING, 0, 1024));
+        ck.push_back(xcb_get_property(c, 0, w, a.netWmIcon, XA_CARDINAL, 0, 0x3fffffff));
+    }
+
+    size_t bytes = 0;
+    for (xcb_get_property_cookie_t c1 : ck) {
+        xcb_generic_error_t *err = nullptr;
+        xcb_get_property_reply_t *r = xcb_get_property_reply(c, c1, &err);
+        if (err) free(err);
+        if (r) {
+            bytes += xcb_get_property_value_length(r);
+            free(r);
+        }
+    }
+    return bytes;
+}
+
+int main(int argc, char **argv) {
+    int n     = argc > 1 ? atoi(argv[1]) : 20;
+    int iters = argc > 2 ? atoi(argv[2]) : 200;
+
+    Display *dpy = XOpenDisplay(nullptr);
+    if (!dpy) {
+        fprintf(stderr, "xprops-bench: cannot open display (start Xvfb first)\n");
+        return 1;
+    }
+
+    Atoms a;
+    a.netWmName = XInternAtom(dpy, "_NET_WM_NAME", False);
+    a.netWmIcon = XInternAtom(dpy, "_NET_WM_ICON", False);
+    a.utf8      = XInternAtom(dpy, "UTF8_STRING", False);
+
+    std::vector<Window> wins = makeClients(dpy, a, n);
+
+    // warm up both paths once
+    fetchXlib(dpy, a, wins);
+    fetchXcb(dpy, a, wins);
+
+    size_t sink = 0;
+    double t0 = nowMs();
+    for (int i = 0; i < iters; i++) sink += fetchXlib(dpy, a, wins);
+    double xlib = (nowMs() - t0) / iters;
+
+    t0 = nowMs();
+    for (int i = 0; i < iters; i++) sink += fetchXcb(dpy, a, wins);
+    double xcb = (nowMs() - t0) / iters;
+
+    printf("%d windows, %d iterations (checksum %zu)\n", n, iters, sink);
+    printf("  xlib sequential : %8.3f ms/refresh\n", xlib);
+    printf("  xcb pipelined   : %8.3f ms/refresh  (%.1fx)\n", xcb, xcb > 0 ? xlib / xcb : 0.0);
+
+    for (Window w : wins) XDestroyWindow(dpy, w);
+    XCloseDisplay(dpy);
+    return 0;
+}
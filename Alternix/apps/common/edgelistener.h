@@ -0,0 +1,104 @@
+// Shared by osm-running, osm-status and osm-notify; include as
+// "common/edgelistener.h".
+#pragma once
+
+#include <QObject>
+#include <QWidget>
+#include <QEvent>
+#include <QTimer>
+#include <QPointer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QDebug>
+#include <functional>
+#include <ctime>
+
+// Swipes come from osm-edged over $XDG_RUNTIME_DIR/<name>.edge as
+// "show <t-ms>". Once the panel has painted we answer "painted <ms>" so
+// osm-edged can log swipe-to-panel latency.
+
+class EdgeListener : public QObject {
+public:
+    EdgeListener(const QString &name, QWidget *watch, std::function<void()> onShow,
+                 QObject *parent = nullptr)
+        : QObject(parent),
+          m_watch(watch),
+          m_onShow(std::move(onShow)),
+          m_swipeMs(0),
+          m_replyQueued(false)
+    {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+        QString path = dir + "/" + name + ".edge";
+
+        QLocalServer::removeServer(path);
+        m_server = new QLocalServer(this);
+        if (!m_server->listen(path))
+            qWarning() << "edge socket" << path << m_server->errorString();
+
+        connect(m_server, &QLocalServer::newConnection, this, [this]() {
+            while (QLocalSocket *s = m_server->nextPendingConnection()) {
+                connect(s, &QLocalSocket::disconnected, s, &QObject::deleteLater);
+                connect(s, &QLocalSocket::readyRead, this, [this, s]() { handle(s); });
+            }
+        });
+
+        m_watch->installEventFilter(this);
+    }
+
+protected:
+    bool eventFilter(QObject *o, QEvent *e) override {
+        if (o == m_watch && e->type() == QEvent::Paint && m_pending && !m_replyQueued) {
+            // reply after the paint has been flushed, not before
+            m_replyQueued = true;
+            QTimer::singleShot(0, this, [this]() { reply(); });
+        }
+        return QObject::eventFilter(o, e);
+    }
+
+private:
+    static qint64 monoMs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    void handle(QLocalSocket *s) {
+        while (s->canReadLine()) {
+            QList<QByteArray> parts = s->readLine().trimmed().split(' ');
+            if (parts.value(0) != "show") continue;
+
+            bool ok = false;
+            qint64 t = parts.value(1).toLongLong(&ok);
+            m_swipeMs = ok ? t : monoMs();
+            m_pending = s;
+            m_replyQueued = false;
+
+            bool wasVisible = m_watch->isVisible();
+            if (m_onShow) m_onShow();
+
+            // already open: nothing will paint, so don't keep osm-edged waiting
+            if (wasVisible) {
+                s->disconnectFromServer();
+                m_pending.clear();
+            }
+        }
+    }
+
+    void reply() {
+        m_replyQueued = false;
+        if (!m_pending) return;
+        m_pending->write(QByteArray("painted ") +
+                         QByteArray::number(monoMs() - m_swipeMs) + "\n");
+        m_pending->flush();
+        m_pending->disconnectFromServer();
+        m_pending.clear();
+    }
+
+    QWidget *m_watch;
+    std::function<void()> m_onShow;
+    QLocalServer *m_server;
+    QPointer<QLocalSocket> m_pending;
+    qint64 m_swipeMs;
+    bool m_replyQueued;
+};
@@ -0,0 +1,30 @@
+// Shared by the single-file Alternix apps; include as "common/fdnotifier.h".
+#pragma once
+
+#include <QSocketNotifier>
+#include <QEvent>
+#include <functional>
+
+// Read-notifier for a raw fd (inotify, netlink, an X connection) that
+// calls a plain function. The activated() signal changed signature in
+// Qt 5.15 and is a private, overloaded signal there, so rather than
+// pick an overload per Qt version this handles the activation event,
+// which every Qt 5 delivers the same way.
+class FdNotifier : public QSocketNotifier {
+public:
+    FdNotifier(int fd, std::function<void()> fn, QObject *parent)
+        : QSocketNotifier(fd, QSocketNotifier::Read, parent),
+          m_fn(fn) {}
+
+protected:
+    bool event(QEvent *e) override {
+        if (e->type() == QEvent::SockAct) {
+            if (m_fn) m_fn();
+            return true;
+        }
+        return QSocketNotifier::event(e);
+    }
+
+private:
+    std::function<void()> m_fn;
+};
@@ -0,0 +1,164 @@
+// Shared by osm-powerd, osm-power and osm-trace; include as
+// "common/osmtrace.h".
+#pragma once
+
+// Trace points for the power-key → menu → suspend → resume path. Each
+// writer appends to its own fixed-size ring and `osm-trace` merges the
+// rings into Chrome trace JSON. Timestamps are CLOCK_BOOTTIME so time
+// spent asleep shows up as the gap it was.
+//
+// Rings live in a directory only their owner can write:
+//   root  /run/osm-trace/<ring>                 (osm-powerd)
+//   user  $XDG_RUNTIME_DIR/osm-trace/<ring>     (osm-power)
+// A ring is always created fresh with O_EXCL, and the directory and file
+// are checked to belong to us, so nobody else can swap in a symlink,
+// truncate the mapping under us or write into it.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+static const uint32_t TRACE_MAGIC    = 0x544d534f;   // "OSMT"
+static const uint32_t TRACE_VERSION  = 1;
+static const uint32_t TRACE_CAPACITY = 4096;
+
+struct TraceRecord {
+    std::atomic<uint64_t> seq;     // index + 1 once written, 0 while writing
+    uint64_t ts;                   // ns, CLOCK_BOOTTIME
+    uint32_t pid;
+    uint32_t tid;
+    char     phase;                // 'i' instant, 'B' begin, 'E' end
+    char     proc[15];
+    char     name[24];
+    char     arg[24];
+};
+
+struct TraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    std::atomic<uint64_t> head;
+};
+
+// Where rings written with our euid live. Empty if XDG_RUNTIME_DIR is unset
+// for a user process.
+inline std::string traceDirPath() {
+    if (geteuid() == 0)
+        return "/run/osm-trace";
+    const char *rt = getenv("XDG_RUNTIME_DIR");
+    if (!rt || !*rt)
+        return std::string();
+    return std::string(rt) + "/osm-trace";
+}
+
+// The directory as an fd, created if needed; -1 unless it is a real
+// directory owned by us that nobody else can write to.
+inline int traceDirFd() {
+    std::string dir = traceDirPath();
+    if (dir.empty())
+        return -1;
+
+    mkdir(dir.c_str(), geteuid() == 0 ? 0755 : 0700);
+    int dfd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dfd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(dfd, &st) < 0 || st.st_uid != geteuid() || (st.st_mode & 022)) {
+        close(dfd);
+        return -1;
+    }
+    return dfd;
+}
+
+inline uint64_t traceNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+struct TraceState {
+    TraceHeader *hdr = nullptr;
+    char proc[15] = {0};
+};
+
+inline TraceState &traceState() {
+    static TraceState s;
+    return s;
+}
+
+// Writers call this once with a fixed ring name; trace() is a no-op until
+// it succeeds. A previous run's ring is replaced, not reused.
+inline bool traceOpen(const char *ring) {
+    TraceState &s = traceState();
+    if (s.hdr)
+        return true;
+
+    int dfd = traceDirFd();
+    if (dfd < 0)
+        return false;
+
+    size_t size = sizeof(TraceHeader) + TRACE_CAPACITY * sizeof(TraceRecord);
+
+    unlinkat(dfd, ring, 0);
+    int fd = openat(dfd, ring, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                    geteuid() == 0 ? 0644 : 0600);
+    close(dfd);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+        st.st_nlink != 1 || ftruncate(fd, off_t(size)) < 0) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    // fresh file: already zeroed
+    TraceHeader *h = static_cast<TraceHeader *>(p);
+    h->version = TRACE_VERSION;
+    h->capacity = TRACE_CAPACITY;
+    h->recordSize = sizeof(TraceRecord);
+    h->magic = TRACE_MAGIC;
+
+    strncpy(s.proc, ring, sizeof(s.proc) - 1);
+    s.hdr = h;
+    return true;
+}
+
+inline void trace(const char *name, char phase = 'i', const char *arg = nullptr, uint64_t ts = 0) {
+    TraceState &s = traceState();
+    TraceHeader *h = s.hdr;
+    if (!h) return;
+    TraceRecord *ring = reinterpret_cast<TraceRecord *>(h + 1);
+
+    uint64_t idx = h->head.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord &r = ring[idx % TRACE_CAPACITY];
+    r.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    r.ts = ts ? ts : traceNow();
+    r.pid = uint32_t(getpid());
+    r.tid = uint32_t(syscall(SYS_gettid));
+    r.phase = phase;
+    memcpy(r.proc, s.proc, sizeof(r.proc));
+    strncpy(r.name, name, sizeof(r.name) - 1);
+    r.name[sizeof(r.name) - 1] = '\0';
+    strncpy(r.arg, arg ? arg : "", sizeof(r.arg) - 1);
+    r.arg[sizeof(r.arg) - 1] = '\0';
+
+    r.seq.store(idx + 1, std::memory_order_release);
+}
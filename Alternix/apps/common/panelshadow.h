@@ -0,0 +1,123 @@
+// Shared by osm-running and osm-status; include as "common/panelshadow.h".
+#pragma once
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QImage>
+#include <QColor>
+#include <QRect>
+#include <qdrawutil.h>
+#include <algorithm>
+#include <vector>
+
+// Soft shadow behind a rounded panel, drawn as a cached nine-patch. The
+// blur runs once per (radii, blur, colour); after that a repaint is nine
+// blits, where QGraphicsDropShadowEffect re-rendered and re-blurred the
+// whole subtree every frame.
+
+class PanelShadow {
+public:
+    // The side panels' shadow. The old effect cast 220-alpha black through
+    // #inner's 50 % background, so the nine-patch is drawn at 110.
+    static const int kPanelBlur  = 32;
+    static const int kPanelAlpha = 110;
+
+    static void paintPanel(QPainter &p, const QRect &shape, const int radii[4]) {
+        paint(p, shape, radii, kPanelBlur, QColor(0, 0, 0, kPanelAlpha));
+    }
+
+    // radii: top-left, top-right, bottom-right, bottom-left
+    static void paint(QPainter &p, const QRect &shape, const int radii[4],
+                      int blur, const QColor &colour)
+    {
+        int maxR = *std::max_element(radii, radii + 4);
+        int k = 2 * blur + maxR;   // outside margin + corner + blur falloff
+
+        QString key = QString("panel-shadow:%1,%2,%3,%4:%5:%6")
+                      .arg(radii[0]).arg(radii[1]).arg(radii[2]).arg(radii[3])
+                      .arg(blur).arg(colour.rgba(), 8, 16, QChar('0'));
+
+        QPixmap pm;
+        if (!QPixmapCache::find(key, &pm)) {
+            pm = render(radii, blur, colour, k);
+            QPixmapCache::insert(key, pm);
+        }
+
+        qDrawBorderPixmap(&p, shape.adjusted(-blur, -blur, blur, blur),
+                          QMargins(k, k, k, k), pm);
+    }
+
+private:
+    // (2k+1)² image: the shape inset by `blur`, blurred, with one
+    // stretchable row/column through the middle
+    static QPixmap render(const int radii[4], int blur, const QColor &colour, int k) {
+        int size = 2 * k + 1;
+        QImage img(size, size, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::transparent);
+
+        QRectF r(blur, blur, size - 2 * blur, size - 2 * blur);
+        QPainterPath path;
+        path.moveTo(r.left() + radii[0], r.top());
+        path.lineTo(r.right() - radii[1], r.top());
+        path.arcTo(r.right() - 2 * radii[1], r.top(), 2 * radii[1], 2 * radii[1], 90, -90);
+        path.lineTo(r.right(), r.bottom() - radii[2]);
+        path.arcTo(r.right() - 2 * radii[2], r.bottom() - 2 * radii[2], 2 * radii[2], 2 * radii[2], 0, -90);
+        path.lineTo(r.left() + radii[3], r.bottom());
+        path.arcTo(r.left(), r.bottom() - 2 * radii[3], 2 * radii[3], 2 * radii[3], 270, -90);
+        path.lineTo(r.left(), r.top() + radii[0]);
+        path.arcTo(r.left(), r.top(), 2 * radii[0], 2 * radii[0], 180, -90);
+        path.closeSubpath();
+
+        {
+            QPainter ip(&img);
+            ip.setRenderHint(QPainter::Antialiasing, true);
+            ip.fillPath(path, Qt::black);
+        }
+
+        // three box passes ≈ gaussian reaching `blur` px out
+        std::vector<int> a(size_t(size) * size);
+        for (int y = 0; y < size; ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+            for (int x = 0; x < size; ++x)
+                a[size_t(y) * size + x] = qAlpha(line[x]);
+        }
+        int box = qMax(1, blur / 3);
+        for (int pass = 0; pass < 3; ++pass) {
+            boxBlur(a, size, box, 1, size);    // rows
+            boxBlur(a, size, box, size, 1);    // columns
+        }
+
+        for (int y = 0; y < size; ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+            for (int x = 0; x < size; ++x) {
+                int alpha = a[size_t(y) * size + x] * colour.alpha() / 255;
+                line[x] = qPremultiply(qRgba(colour.red(), colour.green(), colour.blue(), alpha));
+            }
+        }
+        return QPixmap::fromImage(img);
+    }
+
+    // running-sum box blur along one axis; `step` walks a line, `stride`
+    // moves to the next one
+    static void boxBlur(std::vector<int> &a, int size, int r, int step, int stride) {
+        std::vector<int> src(size);
+        int width = 2 * r + 1;
+        for (int l = 0; l < size; ++l) {
+            int base = l * stride;
+            for (int i = 0; i < size; ++i)
+                src[i] = a[base + i * step];
+
+            int sum = 0;
+            for (int i = -r; i <= r; ++i)
+                sum += (i >= 0 && i < size) ? src[i] : 0;
+            for (int i = 0; i < size; ++i) {
+                a[base + i * step] = sum / width;
+                int out = i - r, in = i + r + 1;
+                if (out >= 0) sum -= src[out];
+                if (in < size) sum += src[in];
+            }
+        }
+    }
+};
@@ -0,0 +1,469 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/extensions/XInput2.h>
+
+// osm-edged: one edge-gesture service for the Alternix shell panels.
+//
+// Replaces the invisible always-on-top ActivationEdgeBar windows that
+// osm-running, osm-status and osm-notify each kept re-raising every 1.5 s.
+// XInput2 raw touch/button events are selected on the root window, which
+// the server delivers no matter which window is on top, so no input window
+// or stacking is needed. A swipe that starts inside an edge zone and moves
+// past the threshold is sent as "show <t-ms>" to that panel's socket in
+// $XDG_RUNTIME_DIR; t is the CLOCK_MONOTONIC time of the triggering event.
+// The panel answers "painted <latency-ms>" after its first paint, which is
+// logged here as swipe-to-panel latency with a running average.
+//
+// Raw events carry untransformed device coordinates, so absolute devices
+// are put through their "Coordinate Transformation Matrix" the same way
+// the server does; a rotated panel (xrandr + matrix) lands on the right
+// edge. The root size and zones follow RandR via ConfigureNotify.
+
+static const int SWIPE_THRESHOLD = 12;     // px, same as the old edge bars
+static const int REPLY_TIMEOUT_MS = 2000;
+
+struct EdgeZone {
+    const char *panel;      // socket: $XDG_RUNTIME_DIR/<panel>.edge
+    int x, y, w, h;
+    int dirX, dirY;         // swipe direction that triggers
+};
+
+struct Tracker {
+    bool active = false;
+    bool fired = false;
+    int zone = -1;
+    double startX = 0, startY = 0;
+    double x = 0, y = 0;
+};
+
+struct AxisRange {
+    bool absolute = false;
+    double minX = 0, maxX = 1, minY = 0, maxY = 1;
+    float matrix[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+    double nx = 0, ny = 0;      // last normalised position; raw events only
+                                // carry the axes that changed
+};
+
+struct PendingReply {
+    int fd;
+    std::string panel;
+    long long sentMs;
+};
+
+struct LatencyStats {
+    double sum = 0;
+    int n = 0;
+};
+
+// A touchscreen can be unplugged between its event and our XIQueryDevice
+// on it; the default handler would exit and take the edge gestures of
+// every panel with it.
+static int ignoreXErrors(Display *, XErrorEvent *) {
+    return 0;
+}
+
+static long long monoMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static std::string runtimeDir() {
+    const char *rt = std::getenv("XDG_RUNTIME_DIR");
+    if (rt && rt[0]) return rt;
+    return "/run/user/" + std::to_string(getuid());
+}
+
+// Same geometry the per-app edge bars used
+static std::vector<EdgeZone> buildZones(int W, int H) {
+    std::vector<EdgeZone> z;
+
+    // osm-running: left edge, swipe right
+    z.push_back({ "osm-running", 0, 0, 25, H, 1, 0 });
+
+    // osm-status: right edge, swipe left
+    z.push_back({ "osm-status", W - 10, 0, 10, H, -1, 0 });
+
+    // osm-notify: top edge minus corners and the clock, swipe down
+    int barHeight = 50;
+    int edgeExcl   = std::min(int(W * 0.18), W / 3);
+    int centerExcl = std::min(int(W * 0.14), W / 3);
+    int usable = W - 2 * edgeExcl - centerExcl;
+    if (usable <= 20) {
+        int bw = W / 2;
+        z.push_back({ "osm-notify", (W - bw) / 2, 0, bw, barHeight, 0, 1 });
+    } else {
+        int sw = usable / 2;
+        z.push_back({ "osm-notify", edgeExcl, 0, sw, barHeight, 0, 1 });
+        z.push_back({ "osm-notify", edgeExcl + sw + centerExcl, 0, sw, barHeight, 0, 1 });
+    }
+    return z;
+}
+
+class EdgeDaemon {
+public:
+    bool open() {
+        m_dpy = XOpenDisplay(nullptr);
+        if (!m_dpy) {
+            std::cerr << "osm-edged: cannot open display\n";
+            return false;
+        }
+        XSetErrorHandler(ignoreXErrors);
+
+        int ev, err;
+        if (!XQueryExtension(m_dpy, "XInputExtension", &m_xiOpcode, &ev, &err)) {
+            std::cerr << "osm-edged: XInput extension not available\n";
+            return false;
+        }
+        int major = 2, minor = 2;
+        if (XIQueryVersion(m_dpy, &major, &minor) != Success ||
+            major < 2 || (major == 2 && minor < 2)) {
+            std::cerr << "osm-edged: need XInput 2.2 for touch, server has "
+                      << major << "." << minor << "\n";
+            return false;
+        }
+
+        m_root = DefaultRootWindow(m_dpy);
+        m_matrixAtom = XInternAtom(m_dpy, "Coordinate Transformation Matrix", False);
+        resize(DisplayWidth(m_dpy, DefaultScreen(m_dpy)),
+               DisplayHeight(m_dpy, DefaultScreen(m_dpy)));
+
+        // root ConfigureNotify is how a RandR rotation reaches us
+        XSelectInput(m_dpy, m_root, StructureNotifyMask);
+
+        unsigned char mask[XIMaskLen(XI_LASTEVENT)];
+        memset(mask, 0, sizeof(mask));
+        XISetMask(mask, XI_RawTouchBegin);
+        XISetMask(mask, XI_RawTouchUpdate);
+        XISetMask(mask, XI_RawTouchEnd);
+        XISetMask(mask, XI_RawButtonPress);
+        XISetMask(mask, XI_RawButtonRelease);
+        XISetMask(mask, XI_RawMotion);
+
+        // the transformation matrix lives on the slave touchscreen, which
+        // is also what raw events name as their source; slave property
+        // changes only arrive with an all-devices selection
+        unsigned char devMask[XIMaskLen(XI_LASTEVENT)];
+        memset(devMask, 0, sizeof(devMask));
+        XISetMask(devMask, XI_HierarchyChanged);
+        XISetMask(devMask, XI_PropertyEvent);
+
+        XIEventMask em[2];
+        em[0].deviceid = XIAllMasterDevices;
+        em[0].mask_len = sizeof(mask);
+        em[0].mask = mask;
+        em[1].deviceid = XIAllDevices;
+        em[1].mask_len = sizeof(devMask);
+        em[1].mask = devMask;
+        XISelectEvents(m_dpy, m_root, em, 2);
+        XFlush(m_dpy);
+
+        std::cout << "osm-edged: watching " << m_zones.size() << " edge zones\n";
+        return true;
+    }
+
+    int run() {
+        while (true) {
+            std::vector<pollfd> fds;
+            fds.push_back({ ConnectionNumber(m_dpy), POLLIN, 0 });
+            for (const PendingReply &p : m_replies)
+                fds.push_back({ p.fd, POLLIN, 0 });
+
+            // Xlib may already hold queued events; don't sleep on them
+            int timeout = XPending(m_dpy) ? 0 : (m_replies.empty() ? -1 : 250);
+            int n = poll(fds.data(), fds.size(), timeout);
+            if (n < 0 && errno != EINTR) {
+                perror("osm-edged: poll");
+                return 1;
+            }
+
+            for (size_t i = 1; i < fds.size(); i++)
+                if (fds[i].revents) readReply(fds[i].fd);
+            expireReplies();
+
+            while (XPending(m_dpy)) {
+                XEvent ev;
+                XNextEvent(m_dpy, &ev);
+                handle(ev);
+            }
+        }
+    }
+
+private:
+    void resize(int W, int H) {
+        m_width = W;
+        m_height = H;
+        m_zones = buildZones(W, H);
+        m_track = Tracker();
+    }
+
+    void handle(XEvent &ev) {
+        if (ev.type == ConfigureNotify && ev.xconfigure.window == m_root) {
+            if (ev.xconfigure.width != m_width || ev.xconfigure.height != m_height)
+                resize(ev.xconfigure.width, ev.xconfigure.height);
+            return;
+        }
+
+        XGenericEventCookie *cookie = &ev.xcookie;
+        if (cookie->type != GenericEvent || cookie->extension != m_xiOpcode)
+            return;
+        if (!XGetEventData(m_dpy, cookie))
+            return;
+
+        if (cookie->evtype == XI_HierarchyChanged) {
+            m_axes.clear();     // devices came or went; re-query lazily
+        } else if (cookie->evtype == XI_PropertyEvent) {
+            const XIPropertyEvent *pe = static_cast<const XIPropertyEvent*>(cookie->data);
+            if (pe->property == m_matrixAtom)
+                m_axes.erase(pe->deviceid);
+        } else {
+            const XIRawEvent *raw = static_cast<const XIRawEvent*>(cookie->data);
+            handleRaw(cookie->evtype, raw);
+        }
+        XFreeEventData(m_dpy, cookie);
+    }
+
+    void handleRaw(int type, const XIRawEvent *raw) {
+        // pointer events synthesised from touches are already seen as touches
+        if (raw->flags & XIPointerEmulated)
+            return;
+
+        bool isTouch = type == XI_RawTouchBegin || type == XI_RawTouchUpdate ||
+                       type == XI_RawTouchEnd;
+        bool begin = type == XI_RawTouchBegin ||
+                     (type == XI_RawButtonPress && raw->detail == 1);
+        bool end   = type == XI_RawTouchEnd ||
+                     (type == XI_RawButtonRelease && raw->detail == 1);
+
+        // one gesture at a time: the first touch (or button 1) owns it
+        if (!begin && (!m_track.active || (isTouch && raw->detail != m_touchId)))
+            return;
+
+        if (end) {
+            m_track = Tracker();
+            return;
+        }
+
+        double x = m_track.x, y = m_track.y;
+        if (!position(raw, isTouch, x, y))
+            return;
+
+        if (begin) {
+            if (m_track.active) return;
+            int zone = zoneAt(x, y);
+            if (zone < 0) return;
+
+            m_track = Tracker();
+            m_track.active = true;
+            m_track.zone = zone;
+            m_track.startX = m_track.x = x;
+            m_track.startY = m_track.y = y;
+            m_touchId = isTouch ? raw->detail : 0;
+            return;
+        }
+
+        m_track.x = x;
+        m_track.y = y;
+        if (m_track.fired) return;
+
+        const EdgeZone &z = m_zones[m_track.zone];
+        double along = (x - m_track.startX) * z.dirX + (y - m_track.startY) * z.dirY;
+        if (along > SWIPE_THRESHOLD) {
+            m_track.fired = true;
+            dispatch(z.panel, eventMs(raw->time));
+        }
+    }
+
+    // X server time is CLOCK_MONOTONIC in ms on Linux; fall back to now
+    // if it does not look like it
+    long long eventMs(Time t) const {
+        long long now = monoMs();
+        long long low = now & 0xffffffffLL;
+        long long diff = low - (long long)t;
+        if (diff < 0) diff += 0x100000000LL;
+        return (diff >= 0 && diff < 1000) ? now - diff : now;
+    }
+
+    int zoneAt(double x, double y) const {
+        for (size_t i = 0; i < m_zones.size(); i++) {
+            const EdgeZone &z = m_zones[i];
+            if (x >= z.x && x < z.x + z.w && y >= z.y && y < z.y + z.h)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    // Screen position of a raw event. Absolute devices (touchscreens)
+    // normalise their axis range, apply the device's transformation matrix
+    // and scale onto the root window, as the server does for cooked events;
+    // relative ones (mice) ask the server where the pointer is, which only
+    // happens mid-gesture.
+    bool position(const XIRawEvent *raw, bool isTouch, double &x, double &y) {
+        AxisRange &ax = axes(raw->sourceid);
+        if (ax.absolute) {
+            const double *v = raw->valuators.values;
+            for (int i = 0; i < raw->valuators.mask_len * 8 && i < 2; i++) {
+                if (!XIMaskIsSet(raw->valuators.mask, i)) continue;
+                if (i == 0) ax.nx = (*v - ax.minX) / (ax.maxX - ax.minX);
+                else        ax.ny = (*v - ax.minY) / (ax.maxY - ax.minY);
+                v++;
+            }
+
+            const float *m = ax.matrix;
+            double tx = m[0] * ax.nx + m[1] * ax.ny + m[2];
+            double ty = m[3] * ax.nx + m[4] * ax.ny + m[5];
+            double tw = m[6] * ax.nx + m[7] * ax.ny + m[8];
+            if (tw == 0) return false;
+            x = tx / tw * m_width;
+            y = ty / tw * m_height;
+            return true;
+        }
+        if (isTouch) return false;
+
+        Window r, c;
+        int rx, ry, wx, wy;
+        unsigned int m;
+        if (!XQueryPointer(m_dpy, m_root, &r, &c, &rx, &ry, &wx, &wy, &m))
+            return false;
+        x = rx;
+        y = ry;
+        return true;
+    }
+
+    AxisRange &axes(int deviceid) {
+        auto it = m_axes.find(deviceid);
+        if (it != m_axes.end()) return it->second;
+
+        AxisRange ax;
+        int n = 0;
+        XIDeviceInfo *info = XIQueryDevice(m_dpy, deviceid, &n);
+        if (info) {
+            bool hx = false, hy = false;
+            for (int i = 0; i < info->num_classes; i++) {
+                if (info->classes[i]->type != XIValuatorClass) continue;
+                XIValuatorClassInfo *v = (XIValuatorClassInfo*)info->classes[i];
+                if (v->mode != XIModeAbsolute || v->max <= v->min) continue;
+                if (v->number == 0) { ax.minX = v->min; ax.maxX = v->max; hx = true; }
+                if (v->number == 1) { ax.minY = v->min; ax.maxY = v->max; hy = true; }
+            }
+            ax.absolute = hx && hy;
+            XIFreeDeviceInfo(info);
+        }
+
+        // 9 row-major FLOATs; 32-bit items come back packed, not as longs
+        Atom type;
+        int format;
+        unsigned long items, after;
+        unsigned char *data = nullptr;
+        if (ax.absolute &&
+            XIGetProperty(m_dpy, deviceid, m_matrixAtom, 0, 9, False, AnyPropertyType,
+                          &type, &format, &items, &after, &data) == Success) {
+            if (format == 32 && items == 9)
+                memcpy(ax.matrix, data, sizeof(ax.matrix));
+            XFree(data);
+        }
+        return m_axes[deviceid] = ax;
+    }
+
+    void dispatch(const char *panel, long long eventMs) {
+        std::string path = runtimeDir() + "/" + panel + ".edge";
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return;
+
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            std::cerr << "osm-edged: " << panel << " is not listening ("
+                      << strerror(errno) << ")\n";
+            close(fd);
+            return;
+        }
+
+        std::string msg = "show " + std::to_string(eventMs) + "\n";
+        if (write(fd, msg.c_str(), msg.size()) != (ssize_t)msg.size()) {
+            close(fd);
+            return;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        m_replies.push_back({ fd, panel, monoMs() });
+    }
+
+    void readReply(int fd) {
+        auto it = std::find_if(m_replies.begin(), m_replies.end(),
+                               [fd](const PendingReply &p) { return p.fd == fd; });
+        if (it == m_replies.end()) return;
+
+        char buf[128];
+        ssize_t n = read(fd, buf, sizeof(buf) - 1);
+        if (n > 0) {
+            buf[n] = 0;
+            double ms = 0;
+            if (sscanf(buf, "painted %lf", &ms) == 1) {
+                LatencyStats &s = m_stats[it->panel];
+                s.sum += ms;
+                s.n++;
+                fprintf(stdout, "osm-edged: %s swipe-to-panel %.1f ms (avg %.1f ms over %d)\n",
+                        it->panel.c_str(), ms, s.sum / s.n, s.n);
+                fflush(stdout);
+            }
+        } else if (n < 0 && errno == EAGAIN) {
+            return;
+        }
+        close(fd);
+        m_replies.erase(it);
+    }
+
+    void expireReplies() {
+        long long now = monoMs();
+        for (auto it = m_replies.begin(); it != m_replies.end();) {
+            if (now - it->sentMs > REPLY_TIMEOUT_MS) {
+                close(it->fd);
+                it = m_replies.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    Display *m_dpy = nullptr;
+    Window m_root = 0;
+    int m_xiOpcode = 0;
+    Atom m_matrixAtom = None;
+    int m_width = 0, m_height = 0;
+    std::vector<EdgeZone> m_zones;
+    Tracker m_track;
+    int m_touchId = 0;
+    std::map<int, AxisRange> m_axes;
+    std::vector<PendingReply> m_replies;
+    std::map<std::string, LatencyStats> m_stats;
+};
+
+int main() {
+    signal(SIGPIPE, SIG_IGN);
+
+    EdgeDaemon d;
+    if (!d.open())
+        return 1;
+    return d.run();
+}
@@ -0,0 +1,606 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <linux/gpio.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+// osm-gpiod: hardware rocker buttons (up / down / select on GPIO lines).
+//
+// Lines are requested through the gpiochip v2 character-device uAPI with
+// edge detection and kernel-side debounce, so the daemon sleeps in
+// epoll_wait until a button actually changes. Long presses are timed in
+// userspace with one timerfd per button.
+//
+// While osm-rocker's overlay is open, presses go to it over
+// $XDG_RUNTIME_DIR/osm-rocker.sock ("up", "down", "select", "close").
+// Otherwise up/down follow the mode osm-rocker stores in
+// ~/.config/Alternix/.osm-gpio-mode.ini and are emitted from a uinput
+// device: volume keys (which osm-powerd handles) or wheel scroll. A short
+// select opens osm-rocker, a long one the power menu.
+//
+// Where the buttons come from is behind GpioBackend:
+//   ChipBackend  /dev/gpiochipN, real hardware or the gpio-sim module
+//   MockBackend  a FIFO taking "<offset> press|release" lines
+//
+// Config, ~/.config/Alternix/osm-gpiod.ini:
+//   chip=/dev/gpiochip0
+//   up=17
+//   down=27
+//   select=22
+//   active_low=true        buttons pull the line to ground
+//   bias=pull-up           pull-up | pull-down | none
+//   debounce_ms=10
+//   long_press_ms=600
+//
+// Runs as the session user, unprivileged. A udev rule installed with it
+// hands /dev/gpiochip* to the "gpio" group and /dev/uinput to "uinput";
+// the user is a member of both, so no line can be claimed beyond what
+// those groups already grant.
+
+static const int MAX_EVENTS = 16;
+static const int REPEAT_MS  = 120;   // up/down auto-repeat while held
+
+enum class Button { Up, Down, Select };
+
+static const char *buttonName(Button b) {
+    switch (b) {
+    case Button::Up:     return "up";
+    case Button::Down:   return "down";
+    case Button::Select: return "select";
+    }
+    return "?";
+}
+
+struct Config {
+    std::string chip = "/dev/gpiochip0";
+    int up = -1;
+    int down = -1;
+    int select = -1;
+    bool activeLow = true;
+    std::string bias = "pull-up";
+    int debounceMs = 10;
+    int longPressMs = 600;
+};
+
+// key=value lines; [sections] and # comments are ignored
+static std::map<std::string, std::string> readIni(const std::string &path) {
+    std::map<std::string, std::string> kv;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == ';' || line[0] == '[')
+            continue;
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+
+        auto trim = [](std::string s) {
+            size_t a = s.find_first_not_of(" \t\r");
+            size_t b = s.find_last_not_of(" \t\r");
+            return a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+        };
+        kv[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+    }
+    return kv;
+}
+
+static std::string configDir() {
+    const char *home = std::getenv("HOME");
+    return std::string(home ? home : "") + "/.config/Alternix";
+}
+
+static Config loadConfig() {
+    Config c;
+    auto kv = readIni(configDir() + "/osm-gpiod.ini");
+    auto num = [&](const char *k, int def) {
+        auto it = kv.find(k);
+        return it == kv.end() ? def : atoi(it->second.c_str());
+    };
+
+    if (kv.count("chip")) c.chip = kv["chip"];
+    c.up = num("up", c.up);
+    c.down = num("down", c.down);
+    c.select = num("select", c.select);
+    if (kv.count("active_low")) c.activeLow = (kv["active_low"] == "true" || kv["active_low"] == "1");
+    if (kv.count("bias")) c.bias = kv["bias"];
+    c.debounceMs = num("debounce_ms", c.debounceMs);
+    c.longPressMs = num("long_press_ms", c.longPressMs);
+    return c;
+}
+
+static uint64_t monoNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+// ---------------------------------------------------------------------------
+// Backends
+
+struct LineEvent {
+    int offset;
+    bool pressed;
+    uint64_t timeNs;     // CLOCK_MONOTONIC
+};
+
+class GpioBackend {
+public:
+    virtual ~GpioBackend() {}
+    virtual int fd() const = 0;                                // for epoll
+    virtual void readEvents(std::vector<LineEvent> &out) = 0;
+};
+
+// gpiochip v2 uAPI: one line request for all buttons, both edges, with
+// the debounce attribute applied to every line in it.
+class ChipBackend : public GpioBackend {
+public:
+    ~ChipBackend() override { if (m_fd >= 0) close(m_fd); }
+
+    bool open(const Config &cfg, const std::vector<int> &offsets) {
+        if (cfg.chip.compare(0, 13, "/dev/gpiochip") != 0 ||
+            cfg.chip.find('/', 13) != std::string::npos) {
+            std::cerr << "osm-gpiod: chip must be a /dev/gpiochipN node\n";
+            return false;
+        }
+
+        int chip = ::open(cfg.chip.c_str(), O_RDWR | O_CLOEXEC | O_NOFOLLOW);
+        if (chip < 0) {
+            perror(cfg.chip.c_str());
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(chip, &st) < 0 || !S_ISCHR(st.st_mode)) {
+            std::cerr << "osm-gpiod: " << cfg.chip << " is not a character device\n";
+            close(chip);
+            return false;
+        }
+
+        struct gpio_v2_line_request req;
+        memset(&req, 0, sizeof(req));
+        for (size_t i = 0; i < offsets.size(); ++i)
+            req.offsets[i] = uint32_t(offsets[i]);
+        req.num_lines = uint32_t(offsets.size());
+        strncpy(req.consumer, "osm-gpiod", sizeof(req.consumer) - 1);
+        req.event_buffer_size = 32;
+
+        uint64_t flags = GPIO_V2_LINE_FLAG_INPUT |
+                         GPIO_V2_LINE_FLAG_EDGE_RISING |
+                         GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        if (cfg.activeLow)              flags |= GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+        if (cfg.bias == "pull-up")      flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+        else if (cfg.bias == "pull-down") flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+        else                            flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+        req.config.flags = flags;
+
+        if (cfg.debounceMs > 0) {
+            req.config.num_attrs = 1;
+            req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+            req.config.attrs[0].attr.debounce_period_us = uint32_t(cfg.debounceMs) * 1000;
+            req.config.attrs[0].mask = (1ull << offsets.size()) - 1;
+        }
+
+        if (ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+            perror("GPIO_V2_GET_LINE_IOCTL");
+            close(chip);
+            return false;
+        }
+        close(chip);   // the line request fd lives on its own
+
+        m_fd = req.fd;
+        fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+        fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+        return true;
+    }
+
+    int fd() const override { return m_fd; }
+
+    // with ACTIVE_LOW the kernel already reports a press as a rising edge
+    void readEvents(std::vector<LineEvent> &out) override {
+        struct gpio_v2_line_event evs[16];
+        ssize_t n;
+        while ((n = read(m_fd, evs, sizeof(evs))) > 0) {
+            for (size_t i = 0; i < size_t(n) / sizeof(evs[0]); ++i) {
+                out.push_back({ int(evs[i].offset),
+                                evs[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE,
+                                uint64_t(evs[i].timestamp_ns) });
+            }
+        }
+    }
+
+private:
+    int m_fd = -1;
+};
+
+// For development without hardware:
+//   mkfifo /tmp/rocker && osm-gpiod --mock /tmp/rocker
+//   echo "17 press" > /tmp/rocker; echo "17 release" > /tmp/rocker
+class MockBackend : public GpioBackend {
+public:
+    ~MockBackend() override { if (m_fd >= 0) close(m_fd); }
+
+    bool open(const std::string &path) {
+        // O_RDWR keeps the FIFO from reporting EOF between writers
+        m_fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (m_fd < 0) {
+            perror(path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    int fd() const override { return m_fd; }
+
+    void readEvents(std::vector<LineEvent> &out) override {
+        char buf[512];
+        ssize_t n;
+        while ((n = read(m_fd, buf, sizeof(buf))) > 0)
+            m_pending.append(buf, size_t(n));
+
+        size_t nl;
+        while ((nl = m_pending.find('\n')) != std::string::npos) {
+            std::string line = m_pending.substr(0, nl);
+            m_pending.erase(0, nl + 1);
+
+            int offset = -1;
+            char what[16] = {0};
+            if (sscanf(line.c_str(), "%d %15s", &offset, what) != 2) continue;
+            out.push_back({ offset, strcmp(what, "press") == 0, monoNs() });
+        }
+    }
+
+private:
+    int m_fd = -1;
+    std::string m_pending;
+};
+
+// ---------------------------------------------------------------------------
+// Output when the overlay is closed: a small virtual device. It also has
+// pointer bits so it is classified as a mouse and the wheel is honoured.
+
+class VirtualInput {
+public:
+    bool open() {
+        m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (m_fd < 0) {
+            perror("/dev/uinput");
+            return false;
+        }
+
+        ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
+        ioctl(m_fd, UI_SET_EVBIT, EV_REL);
+        ioctl(m_fd, UI_SET_EVBIT, EV_SYN);
+        ioctl(m_fd, UI_SET_KEYBIT, KEY_VOLUMEUP);
+        ioctl(m_fd, UI_SET_KEYBIT, KEY_VOLUMEDOWN);
+        ioctl(m_fd, UI_SET_KEYBIT, BTN_LEFT);
+        ioctl(m_fd, UI_SET_RELBIT, REL_X);
+        ioctl(m_fd, UI_SET_RELBIT, REL_Y);
+        ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL);
+
+        struct uinput_setup us;
+        memset(&us, 0, sizeof(us));
+        us.id.bustype = BUS_VIRTUAL;
+        us.id.vendor = 0x4f53;   // "OS"
+        us.id.product = 0x0001;
+        strncpy(us.name, "osm-gpiod rocker", UINPUT_MAX_NAME_SIZE - 1);
+
+        if (ioctl(m_fd, UI_DEV_SETUP, &us) < 0 || ioctl(m_fd, UI_DEV_CREATE) < 0) {
+            perror("uinput setup");
+            close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    void key(int code) {
+        emit(EV_KEY, code, 1);
+        emit(EV_SYN, SYN_REPORT, 0);
+        emit(EV_KEY, code, 0);
+        emit(EV_SYN, SYN_REPORT, 0);
+    }
+
+    void wheel(int clicks) {
+        emit(EV_REL, REL_WHEEL, clicks);
+        emit(EV_SYN, SYN_REPORT, 0);
+    }
+
+private:
+    void emit(int type, int code, int value) {
+        if (m_fd < 0) return;
+        struct input_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = uint16_t(type);
+        ev.code = uint16_t(code);
+        ev.value = value;
+        if (write(m_fd, &ev, sizeof(ev)) < 0)
+            perror("uinput write");
+    }
+
+    int m_fd = -1;
+};
+
+// ---------------------------------------------------------------------------
+
+struct ButtonState {
+    Button button;
+    int offset;
+    int timerFd = -1;
+    bool down = false;
+    bool longFired = false;
+};
+
+struct Daemon {
+    Config cfg;
+    std::unique_ptr<GpioBackend> gpio;
+    VirtualInput vinput;
+    std::vector<ButtonState> buttons;
+    int epfd = -1;
+    int sigFd = -1;
+
+    ButtonState *byOffset(int offset) {
+        for (auto &b : buttons)
+            if (b.offset == offset) return &b;
+        return nullptr;
+    }
+
+    ButtonState *byTimer(int fd) {
+        for (auto &b : buttons)
+            if (b.timerFd == fd) return &b;
+        return nullptr;
+    }
+
+    void arm(ButtonState &b, int firstMs, int repeatMs) {
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_sec = firstMs / 1000;
+        its.it_value.tv_nsec = long(firstMs % 1000) * 1000000;
+        its.it_interval.tv_sec = repeatMs / 1000;
+        its.it_interval.tv_nsec = long(repeatMs % 1000) * 1000000;
+        timerfd_settime(b.timerFd, 0, &its, nullptr);
+    }
+
+    void disarm(ButtonState &b) {
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        timerfd_settime(b.timerFd, 0, &its, nullptr);
+    }
+
+    // Up/down act on press and auto-repeat once held past the long-press
+    // time. Select waits for release (short) or the timer (long).
+    void onLine(const LineEvent &e) {
+        ButtonState *b = byOffset(e.offset);
+        if (!b || b->down == e.pressed) return;
+        b->down = e.pressed;
+
+        if (e.pressed) {
+            b->longFired = false;
+            if (b->button == Button::Select) {
+                arm(*b, cfg.longPressMs, 0);
+            } else {
+                press(b->button, false);
+                arm(*b, cfg.longPressMs, REPEAT_MS);
+            }
+            uint64_t lag = monoNs() - e.timeNs;
+            std::cout << buttonName(b->button) << " down ("
+                      << lag / 1000 << " us after the edge)" << std::endl;
+        } else {
+            disarm(*b);
+            if (b->button == Button::Select && !b->longFired)
+                press(Button::Select, false);
+        }
+    }
+
+    void onTimer(ButtonState &b) {
+        uint64_t expirations = 0;
+        if (read(b.timerFd, &expirations, sizeof(expirations)) != sizeof(expirations))
+            return;
+        if (!b.down) return;
+
+        b.longFired = true;
+        press(b.button, b.button == Button::Select);
+    }
+
+    // ── dispatch ──
+
+    static std::string runtimeDir() {
+        const char *d = std::getenv("XDG_RUNTIME_DIR");
+        return (d && d[0]) ? d : "/run/user/" + std::to_string(getuid());
+    }
+
+    static bool sendLine(const std::string &sock, const char *line) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, sock.c_str(), sizeof(addr.sun_path) - 1);
+
+        size_t len = strlen(line);
+        bool ok = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+                  send(fd, line, len, MSG_NOSIGNAL) == ssize_t(len);
+        close(fd);
+        return ok;
+    }
+
+    // osm-rocker writes this through QSettings: "[General]\nmode=volume"
+    std::string mode() {
+        auto kv = readIni(configDir() + "/.osm-gpio-mode.ini");
+        auto it = kv.find("mode");
+        return it == kv.end() ? "volume" : it->second;
+    }
+
+    void spawn(const char *prog, const char *arg) {
+        // children must not inherit the SIGCHLD block used for signalfd
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t none;
+        sigemptyset(&none);
+        posix_spawnattr_setsigmask(&attr, &none);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+        char *argv[] = { const_cast<char *>(prog), const_cast<char *>(arg), nullptr };
+        if (!arg) argv[1] = nullptr;
+
+        pid_t pid;
+        if (posix_spawnp(&pid, prog, nullptr, &attr, argv, environ) != 0)
+            perror(prog);
+        posix_spawnattr_destroy(&attr);
+    }
+
+    void press(Button b, bool isLong) {
+        std::string rt = runtimeDir();
+
+        // overlay open: it owns the rocker
+        const char *cmd = b == Button::Up   ? "up\n"
+                        : b == Button::Down ? "down\n"
+                        : isLong            ? "close\n"
+                                            : "select\n";
+        if (sendLine(rt + "/osm-rocker.sock", cmd))
+            return;
+
+        switch (b) {
+        case Button::Up:
+        case Button::Down: {
+            bool up = (b == Button::Up);
+            if (mode() == "scroll")
+                vinput.wheel(up ? 1 : -1);
+            else
+                vinput.key(up ? KEY_VOLUMEUP : KEY_VOLUMEDOWN);
+            break;
+        }
+        case Button::Select:
+            if (isLong) {
+                if (!sendLine(rt + "/osm-power.sock", "show\n"))
+                    spawn("osm-power", nullptr);
+            } else {
+                spawn("osm-rocker", nullptr);
+            }
+            break;
+        }
+    }
+
+    void reapChildren() {
+        struct signalfd_siginfo si;
+        while (read(sigFd, &si, sizeof(si)) == sizeof(si)) {}
+        while (waitpid(-1, nullptr, WNOHANG) > 0) {}
+    }
+
+    void watch(int fd) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+            perror("epoll_ctl");
+    }
+};
+
+int main(int argc, char **argv) {
+    Daemon d;
+    d.cfg = loadConfig();
+
+    std::string mockPath;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--mock") && i + 1 < argc)
+            mockPath = argv[++i];
+        else if (!strcmp(argv[i], "--chip") && i + 1 < argc)
+            d.cfg.chip = argv[++i];
+    }
+
+    if (d.cfg.up < 0 || d.cfg.down < 0 || d.cfg.select < 0) {
+        std::cerr << "osm-gpiod: no rocker lines configured in "
+                  << configDir() << "/osm-gpiod.ini, exiting\n";
+        return 0;
+    }
+
+    d.buttons = {
+        { Button::Up,     d.cfg.up     },
+        { Button::Down,   d.cfg.down   },
+        { Button::Select, d.cfg.select },
+    };
+
+    if (mockPath.empty()) {
+        auto chip = std::unique_ptr<ChipBackend>(new ChipBackend);
+        if (!chip->open(d.cfg, { d.cfg.up, d.cfg.down, d.cfg.select }))
+            return 1;
+        d.gpio = std::move(chip);
+    } else {
+        auto mock = std::unique_ptr<MockBackend>(new MockBackend);
+        if (!mock->open(mockPath))
+            return 1;
+        d.gpio = std::move(mock);
+    }
+
+    d.vinput.open();   // without it only the overlay path works
+
+    d.epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (d.epfd < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, nullptr);
+    d.sigFd = signalfd(-1, &chld, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (d.sigFd >= 0)
+        d.watch(d.sigFd);
+
+    d.watch(d.gpio->fd());
+    for (auto &b : d.buttons) {
+        b.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        d.watch(b.timerFd);
+    }
+
+    std::cout << "osm-gpiod: rocker up=" << d.cfg.up << " down=" << d.cfg.down
+              << " select=" << d.cfg.select << " on "
+              << (mockPath.empty() ? d.cfg.chip : mockPath) << std::endl;
+
+    struct epoll_event events[MAX_EVENTS];
+    std::vector<LineEvent> lineEvents;
+
+    while (true) {
+        int n = epoll_wait(d.epfd, events, MAX_EVENTS, -1);
+        if (n < 0)
+            continue;
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == d.sigFd) {
+                d.reapChildren();
+            } else if (fd == d.gpio->fd()) {
+                lineEvents.clear();
+                d.gpio->readEvents(lineEvents);
+                for (const auto &e : lineEvents)
+                    d.onLine(e);
+            } else if (ButtonState *b = d.byTimer(fd)) {
+                d.onTimer(*b);
+            }
+        }
+    }
+
+    return 0;
+}
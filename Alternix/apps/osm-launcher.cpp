@@ -24,6 +24,8 @@
 #include <QVector>
 #include <QDir>
 #include <QLockFile>
+#include <QStandardPaths>
+#include <QDateTime>
 #include <algorithm>
 
 // ──────────────────────────────  Window with built-in top/bottom fade
@@ -58,6 +60,31 @@ protected:
     }
 };
 
+// ──────────────────────────────  Launch
+// With the osm-running freezer enabled every app gets its own transient
+// systemd scope under osm-apps.slice, which osm-running can then freeze
+// and thaw as a whole through cgroup.freeze.
+static void launchApp(const QString &prog, const QStringList &args) {
+    QSettings cfg(QDir::homePath() + "/.config/Alternix/osm-freezer.conf",
+                  QSettings::IniFormat);
+    QString runner = QStandardPaths::findExecutable("systemd-run");
+
+    if (cfg.value("Freezer/enabled", false).toBool() && !runner.isEmpty()) {
+        QString name = QFileInfo(prog).fileName();
+        for (QChar &c : name)
+            if (!c.isLetterOrNumber() && c != '_' && c != '.' && c != '-') c = '_';
+
+        QString unit = QString("osm-app-%1-%2")
+                           .arg(name).arg(QDateTime::currentMSecsSinceEpoch());
+        QStringList full{ "--user", "--scope", "--quiet", "--collect",
+                          "--slice=osm-apps.slice", "--unit=" + unit, "--", prog };
+        full << args;
+        if (QProcess::startDetached(runner, full))
+            return;
+    }
+    QProcess::startDetached(prog, args);
+}
+
 // ──────────────────────────────  Clean exec fields (unchanged)
 static QString cleanExec(const QString &exec) {
     QString s = exec;
@@ -211,7 +238,7 @@ protected:
             QStringList args = entry.exec.split(' ');
             if (!args.isEmpty()) {
                 QString prog = args.takeFirst();
-                QProcess::startDetached(prog, args);
+                launchApp(prog, args);
             }
             if (QWidget *w = window()) w->close();
         }
@@ -0,0 +1,482 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <syslog.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XRes.h>
+
+// osm-lmkd: low-memory killer for the Alternix session.
+//
+// Arms a PSI trigger on /proc/pressure/memory and, when it fires, closes the
+// least recently used background app before the kernel OOM killer picks
+// something arbitrary (often the shell overlays). Recency comes from
+// osm-running's $XDG_RUNTIME_DIR/osm-running.activity. The victim first gets
+// a polite WM_DELETE_WINDOW, then SIGTERM, then SIGKILL, escalating only
+// while its window is still listed. osm-* shell components, the session and
+// the focused app are never chosen.
+//
+// The pid comes from the X server (XRes), not the client's _NET_WM_PID,
+// which is namespace-local for flatpak and friends. Apps osm-launcher put in
+// an osm-app-*.scope are signalled as the whole scope, thawed first in case
+// osm-running's freezer has them stopped.
+//
+// Usage: osm-lmkd [stall-ms] [window-ms]
+//   defaults 150 2000: act when tasks stall >=150 ms on memory within 2 s.
+//   (unprivileged PSI triggers need a window that is a multiple of 2 s)
+
+static const int GRACE_DELETE_MS = 5000;   // WM_DELETE_WINDOW → SIGTERM
+static const int GRACE_TERM_MS   = 3000;   // SIGTERM → SIGKILL
+static const int COOLDOWN_MS     = 10000;  // after a victim is gone
+
+// Never killed: shell components and the session itself (comm prefix)
+static const char *PROTECTED[] = {
+    "osm-", "qtile", "picom", "onboard", "touchegg", "Xorg", "Xlibre", "xinit",
+    "pulseaudio", "pipewire", "wireplumber", "dbus-", "systemd",
+};
+
+struct Candidate {
+    Window win;
+    pid_t pid;
+    std::string scope;      // cgroup dir if launched into an osm-app scope
+    std::string comm;
+    std::string cls;
+    long long lastActive;   // epoch ms; unknown counts as now
+    bool seenActive;        // osm-running has a focus time for it
+    long rssKb;
+};
+
+struct Victim {
+    Window win = 0;
+    pid_t pid = 0;
+    std::string scope;
+    int stage = 0;          // 0 none, 1 asked to close, 2 SIGTERM, 3 SIGKILL
+    long long deadline = 0;
+    std::string comm;
+};
+
+static long long nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static std::string readFirstLine(const std::string &path) {
+    std::ifstream f(path);
+    std::string line;
+    std::getline(f, line);
+    return line;
+}
+
+// VmRSS / field from /proc/<pid>/status or /proc/meminfo, in kB
+static long readKb(const std::string &path, const char *key) {
+    std::ifstream f(path);
+    std::string line;
+    size_t klen = strlen(key);
+    while (std::getline(f, line)) {
+        if (line.compare(0, klen, key) == 0)
+            return strtol(line.c_str() + klen, nullptr, 10);
+    }
+    return -1;
+}
+
+static bool isProtected(const std::string &comm, const std::string &cls) {
+    for (const char *p : PROTECTED) {
+        size_t n = strlen(p);
+        if (comm.compare(0, n, p) == 0 || cls.compare(0, n, p) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool alive(pid_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// The osm-app-*.scope (see osm-launcher) pid runs in, or empty
+static std::string scopeOf(pid_t pid) {
+    std::string slice = "/sys/fs/cgroup/user.slice/user-" + std::to_string(getuid()) +
+                        ".slice/user@" + std::to_string(getuid()) +
+                        ".service/osm-apps.slice/osm-app-";
+    std::ifstream f("/proc/" + std::to_string(pid) + "/cgroup");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.compare(0, 3, "0::") != 0) continue;
+        std::string path = "/sys/fs/cgroup" + line.substr(3);
+        if (path.compare(0, slice.size(), slice) == 0)
+            return path;
+    }
+    return std::string();
+}
+
+static std::vector<pid_t> scopeProcs(const std::string &scope) {
+    std::vector<pid_t> out;
+    std::ifstream f(scope + "/cgroup.procs");
+    pid_t pid;
+    while (f >> pid)
+        out.push_back(pid);
+    return out;
+}
+
+static void writeCgroup(const std::string &path, const char *value) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    if (write(fd, value, strlen(value)) < 0) {}
+    close(fd);
+}
+
+static bool victimAlive(const Victim &v) {
+    if (v.scope.empty())
+        return alive(v.pid);
+    return !scopeProcs(v.scope).empty();
+}
+
+// A frozen task can't handle WM_DELETE_WINDOW or SIGTERM, so thaw before
+// every step (the freezer may have re-frozen an idle victim meanwhile).
+static void thaw(const Victim &v) {
+    if (!v.scope.empty())
+        writeCgroup(v.scope + "/cgroup.freeze", "0");
+}
+
+static void signalVictim(const Victim &v, int sig) {
+    thaw(v);
+    if (v.scope.empty()) {
+        kill(v.pid, sig);
+        return;
+    }
+    if (sig == SIGKILL && access((v.scope + "/cgroup.kill").c_str(), W_OK) == 0) {
+        writeCgroup(v.scope + "/cgroup.kill", "1");
+        return;
+    }
+    for (pid_t pid : scopeProcs(v.scope))
+        kill(pid, sig);
+}
+
+// "<window> <epoch-ms>" per line, written by osm-running
+static std::map<Window, long long> readActivity() {
+    std::map<Window, long long> out;
+    const char *rt = std::getenv("XDG_RUNTIME_DIR");
+    std::string path = std::string(rt ? rt : "/run/user/" + std::to_string(getuid()))
+                       + "/osm-running.activity";
+    std::ifstream f(path);
+    std::string win;
+    long long ms;
+    while (f >> win >> ms)
+        out[(Window)strtoul(win.c_str(), nullptr, 0)] = ms;
+    return out;
+}
+
+class X11Session {
+public:
+    bool open() {
+        m_dpy = XOpenDisplay(nullptr);
+        if (!m_dpy) return false;
+        XSetErrorHandler([](Display*, XErrorEvent*) { return 0; });
+        m_clientList = XInternAtom(m_dpy, "_NET_CLIENT_LIST", False);
+        m_active     = XInternAtom(m_dpy, "_NET_ACTIVE_WINDOW", False);
+        m_pid        = XInternAtom(m_dpy, "_NET_WM_PID", False);
+        m_protocols  = XInternAtom(m_dpy, "WM_PROTOCOLS", False);
+        m_delete     = XInternAtom(m_dpy, "WM_DELETE_WINDOW", False);
+
+        int ev, err, major = 0, minor = 0;
+        m_hasXRes = XResQueryExtension(m_dpy, &ev, &err) &&
+                    XResQueryVersion(m_dpy, &major, &minor) &&
+                    (major > 1 || (major == 1 && minor >= 2));
+        if (!m_hasXRes)
+            syslog(LOG_WARNING, "no X-Resource 1.2; only osm-launcher scopes can be closed");
+        return true;
+    }
+
+    bool listed(Window w) {
+        Window active;
+        std::vector<Window> wins = clients(active);
+        return std::find(wins.begin(), wins.end(), w) != wins.end();
+    }
+
+    // Host pid of the client that owns w, as the server sees its socket.
+    // Unlike _NET_WM_PID this can't be a pid from another namespace.
+    // Without XRes, _NET_WM_PID is only believed if it lands in one of
+    // our osm-app scopes.
+    pid_t clientPid(Window w) {
+        if (m_hasXRes) {
+            XResClientIdSpec spec;
+            spec.client = w;
+            spec.mask = XRES_CLIENT_ID_PID_MASK;
+            long n = 0;
+            XResClientIdValue *ids = nullptr;
+            pid_t pid = 0;
+            if (XResQueryClientIds(m_dpy, 1, &spec, &n, &ids) == Success) {
+                for (long i = 0; i < n; i++)
+                    if (XResGetClientIdType(&ids[i]) == XRES_CLIENT_ID_PID_MASK)
+                        pid = XResGetClientPid(&ids[i]);
+                XResClientIdsDestroy(n, ids);
+            }
+            return pid > 0 ? pid : 0;
+        }
+
+        pid_t pid = pidOf(w);
+        return (pid > 0 && !scopeOf(pid).empty()) ? pid : 0;
+    }
+
+    std::vector<Window> clients(Window &active) {
+        std::vector<Window> out;
+        Window root = DefaultRootWindow(m_dpy);
+        active = 0;
+
+        unsigned long n = 0;
+        unsigned char *data = prop(root, m_clientList, XA_WINDOW, n);
+        if (data) {
+            out.assign((Window*)data, (Window*)data + n);
+            XFree(data);
+        }
+        data = prop(root, m_active, XA_WINDOW, n);
+        if (data) {
+            if (n) active = *(Window*)data;
+            XFree(data);
+        }
+        return out;
+    }
+
+    pid_t pidOf(Window w) {
+        unsigned long n = 0;
+        unsigned char *data = prop(w, m_pid, XA_CARDINAL, n);
+        pid_t pid = 0;
+        if (data) {
+            if (n) pid = (pid_t)*(unsigned long*)data;
+            XFree(data);
+        }
+        return pid;
+    }
+
+    std::string classOf(Window w) {
+        XClassHint hint;
+        std::string cls;
+        if (XGetClassHint(m_dpy, w, &hint)) {
+            if (hint.res_class) cls = hint.res_class;
+            if (hint.res_name) XFree(hint.res_name);
+            if (hint.res_class) XFree(hint.res_class);
+        }
+        return cls;
+    }
+
+    // Ask politely, the same way a titlebar close button would
+    bool requestClose(Window w) {
+        Atom *protos = nullptr;
+        int count = 0;
+        bool supported = false;
+        if (XGetWMProtocols(m_dpy, w, &protos, &count)) {
+            for (int i = 0; i < count; i++)
+                if (protos[i] == m_delete) supported = true;
+            XFree(protos);
+        }
+        if (!supported) return false;
+
+        XEvent e;
+        memset(&e, 0, sizeof(e));
+        e.xclient.type = ClientMessage;
+        e.xclient.window = w;
+        e.xclient.message_type = m_protocols;
+        e.xclient.format = 32;
+        e.xclient.data.l[0] = m_delete;
+        e.xclient.data.l[1] = CurrentTime;
+        XSendEvent(m_dpy, w, False, NoEventMask, &e);
+        XFlush(m_dpy);
+        return true;
+    }
+
+private:
+    unsigned char *prop(Window w, Atom a, Atom type, unsigned long &n) {
+        Atom actual;
+        int format;
+        unsigned long after;
+        unsigned char *data = nullptr;
+        n = 0;
+        if (XGetWindowProperty(m_dpy, w, a, 0, (~0L), False, type,
+                               &actual, &format, &n, &after, &data) != Success)
+            return nullptr;
+        return data;
+    }
+
+    Display *m_dpy = nullptr;
+    Atom m_clientList, m_active, m_pid, m_protocols, m_delete;
+    bool m_hasXRes = false;
+};
+
+// Least recently active, unprotected, unfocused client; ties go to bigger RSS.
+// A window osm-running has no focus time for counts as just used, so it is
+// never chosen ahead of one known to be idle.
+static bool pickVictim(X11Session &x, Candidate &out) {
+    Window active = 0;
+    std::vector<Window> wins = x.clients(active);
+    std::map<Window, long long> activity = readActivity();
+    pid_t activePid = active ? x.clientPid(active) : 0;
+    std::string activeScope = activePid ? scopeOf(activePid) : std::string();
+    long long nowEpoch = time(nullptr) * 1000LL;
+
+    bool found = false;
+    for (Window w : wins) {
+        if (w == active) continue;
+
+        pid_t pid = x.clientPid(w);
+        if (pid <= 0 || pid == getpid() || pid == activePid) continue;
+
+        std::string scope = scopeOf(pid);
+        if (!scope.empty() && scope == activeScope) continue;
+
+        std::string comm = readFirstLine("/proc/" + std::to_string(pid) + "/comm");
+        std::string cls  = x.classOf(w);
+        if (comm.empty() || isProtected(comm, cls)) continue;
+
+        auto it = activity.find(w);
+        bool seen = it != activity.end();
+        Candidate c { w, pid, scope, comm, cls, seen ? it->second : nowEpoch, seen,
+                      readKb("/proc/" + std::to_string(pid) + "/status", "VmRSS:") };
+
+        if (!found || c.lastActive < out.lastActive ||
+            (c.lastActive == out.lastActive && c.rssKb > out.rssKb)) {
+            out = c;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Arm a PSI trigger; the fd then polls POLLPRI when the threshold is crossed
+static int armPsi(long stallUs, long windowUs) {
+    int fd = open("/proc/pressure/memory", O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        perror("osm-lmkd: /proc/pressure/memory");
+        return -1;
+    }
+    std::string trig = "some " + std::to_string(stallUs) + " " + std::to_string(windowUs);
+    if (write(fd, trig.c_str(), trig.size() + 1) < 0) {
+        perror("osm-lmkd: PSI trigger");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    long stallMs  = argc > 1 ? atol(argv[1]) : 150;
+    long windowMs = argc > 2 ? atol(argv[2]) : 2000;
+
+    openlog("osm-lmkd", LOG_PID | LOG_PERROR, LOG_DAEMON);
+    signal(SIGPIPE, SIG_IGN);
+
+    X11Session x;
+    if (!x.open()) {
+        syslog(LOG_ERR, "cannot open X display");
+        return 1;
+    }
+
+    int psi = armPsi(stallMs * 1000, windowMs * 1000);
+    if (psi < 0) return 1;
+
+    syslog(LOG_INFO, "watching memory pressure: some %ld ms / %ld ms", stallMs, windowMs);
+
+    Victim v;
+    long long quietUntil = 0;
+
+    while (true) {
+        int timeout = -1;
+        if (v.stage > 0)
+            timeout = (int)std::max(0LL, v.deadline - nowMs());
+
+        pollfd pfd { psi, POLLPRI, 0 };
+        int n = poll(&pfd, 1, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("osm-lmkd: poll");
+            return 1;
+        }
+        if (pfd.revents & POLLERR) {
+            syslog(LOG_ERR, "PSI trigger went away");
+            return 1;
+        }
+
+        long long now = nowMs();
+
+        // escalate on the current victim first, but only while its window
+        // is still there: a multi-window app that closed just that window
+        // did what was asked and keeps running
+        if (v.stage > 0 && now >= v.deadline) {
+            if (!victimAlive(v) || !x.listed(v.win)) {
+                syslog(LOG_NOTICE, "%s (pid %d) closed its window; MemAvailable %ld kB",
+                       v.comm.c_str(), v.pid, readKb("/proc/meminfo", "MemAvailable:"));
+                v = Victim();
+                quietUntil = now + COOLDOWN_MS;
+            } else if (v.stage == 1) {
+                syslog(LOG_WARNING, "%s (pid %d) ignored WM_DELETE_WINDOW, sending SIGTERM",
+                       v.comm.c_str(), v.pid);
+                signalVictim(v, SIGTERM);
+                v.stage = 2;
+                v.deadline = now + GRACE_TERM_MS;
+            } else if (v.stage == 2) {
+                syslog(LOG_WARNING, "%s (pid %d) survived SIGTERM, sending SIGKILL",
+                       v.comm.c_str(), v.pid);
+                signalVictim(v, SIGKILL);
+                v.stage = 3;
+                v.deadline = now + GRACE_TERM_MS;
+            } else {
+                syslog(LOG_ERR, "%s (pid %d) still present after SIGKILL, giving up on it",
+                       v.comm.c_str(), v.pid);
+                v = Victim();
+                quietUntil = now + COOLDOWN_MS;
+            }
+        }
+
+        if (!(pfd.revents & POLLPRI)) continue;
+        if (v.stage > 0 || now < quietUntil) continue;   // one victim at a time
+
+        std::string pressure = readFirstLine("/proc/pressure/memory");
+        long avail = readKb("/proc/meminfo", "MemAvailable:");
+
+        Candidate c;
+        if (!pickVictim(x, c)) {
+            syslog(LOG_WARNING, "memory pressure (%s, MemAvailable %ld kB) but no eligible background app",
+                   pressure.c_str(), avail);
+            quietUntil = now + COOLDOWN_MS;
+            continue;
+        }
+
+        std::string idle = c.seenActive
+            ? std::to_string((time(nullptr) * 1000LL - c.lastActive) / 1000) + " s"
+            : std::string("unknown");
+        syslog(LOG_NOTICE, "memory pressure (%s, MemAvailable %ld kB): closing %s [%s] pid %d, "
+               "RSS %ld kB, idle %s",
+               pressure.c_str(), avail, c.comm.c_str(), c.cls.c_str(), c.pid, c.rssKb,
+               idle.c_str());
+
+        v.win = c.win;
+        v.pid = c.pid;
+        v.scope = c.scope;
+        v.comm = c.comm;
+        thaw(v);
+        if (x.requestClose(c.win)) {
+            v.stage = 1;
+            v.deadline = now + GRACE_DELETE_MS;
+        } else {
+            syslog(LOG_NOTICE, "%s has no WM_DELETE_WINDOW, sending SIGTERM", c.comm.c_str());
+            signalVictim(v, SIGTERM);
+            v.stage = 2;
+            v.deadline = now + GRACE_TERM_MS;
+        }
+    }
+
+    return 0;
+}
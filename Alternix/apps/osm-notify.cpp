@@ -15,6 +15,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <QTime>
+#include <QDateTime>
 #include <QLinearGradient>
 #include <QFileInfo>
 #include <QSet>
@@ -26,7 +27,7 @@
 #include <cmath>
 #include <QImage>
 #include <QColor>
-#include <QGraphicsOpacityEffect>
+#include <QVariantAnimation>
 #include <QPropertyAnimation>
 #include <QSequentialAnimationGroup>
 #include <QParallelAnimationGroup>
@@ -37,12 +38,43 @@
 #include <QKeyEvent>
 #include <QShowEvent>
 #include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <QEvent>
+#include <QUrl>
+#include <QIcon>
+#include <QVector>
+#include <QDebug>
+#include <QStandardPaths>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <ctime>
+#include <climits>
 #include <algorithm>
 #include <QPropertyAnimation>
 
 #include <QtDBus/QDBusConnection>
-#include <QtDBus/QDBusInterface>
-#include <QtDBus/QDBusReply>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusArgument>
+#include <QtDBus/QDBusObjectPath>
+#include <QtDBus/QDBusVariant>
+#include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusServiceWatcher>
+#include <QtDBus/QDBusVirtualObject>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#include "common/fdnotifier.h"
+#include "common/edgelistener.h"
 
 // ──────────────────────────────  Helper: read file
 static QString readFile(const QString &path) {
@@ -82,15 +114,6 @@ static QString detectWifiInterface() {
     return "wlan0";
 }
 
-static bool wifiOn_nm(const QString &iface = QString()) {
-    Q_UNUSED(iface);
-    QProcess p;
-    p.start("bash", {"-c", "nmcli radio wifi"});
-    p.waitForFinished(200);
-    QString out = QString::fromUtf8(p.readAll()).trimmed();
-    return (out == "enabled");
-}
-
 static int wifiQualityPercent(const QString &iface) {
     QFile f("/proc/net/wireless");
     if (!f.open(QIODevice::ReadOnly)) return -1;
@@ -111,84 +134,189 @@ static int wifiQualityPercent(const QString &iface) {
     return -1;
 }
 
-static QString detectWifiSsid(const QString &iface) {
-    Q_UNUSED(iface);
+// ──────────────────────────────  Wi-Fi state (NetworkManager D-Bus)
+// Radio state, SSID and signal are NetworkManager properties. Every read
+// is an async call, and PropertiesChanged on the manager, the wireless
+// device and its active access point triggers a re-read, so the card
+// updates by itself without blocking or spawning processes.
 
-    // Try iwgetid first
+static const char *NM_SERVICE  = "org.freedesktop.NetworkManager";
+static const char *NM_PATH     = "/org/freedesktop/NetworkManager";
+static const char *NM_IFACE    = "org.freedesktop.NetworkManager";
+static const char *NM_WIRELESS = "org.freedesktop.NetworkManager.Device.Wireless";
+static const char *NM_AP       = "org.freedesktop.NetworkManager.AccessPoint";
+static const char *DBUS_PROPS  = "org.freedesktop.DBus.Properties";
+
+class WifiMonitor : public QObject {
+public:
+    std::function<void(const QString&)> onChanged;
+
+    explicit WifiMonitor(const QString &iface, QObject *parent = nullptr)
+        : QObject(parent),
+          m_iface(iface),
+          m_bus(QDBusConnection::systemBus()),
+          m_available(false),
+          m_enabled(false),
+          m_strength(-1)
     {
-        QProcess p;
-        p.start("bash", {"-c", "iwgetid -r 2>/dev/null"});
-        p.waitForFinished(600);
-        QString ssid = QString::fromUtf8(p.readAll()).trimmed();
-        if (!ssid.isEmpty()) return ssid;
+        m_text = text();
+
+        // a signal burst (scan results, roaming) becomes one re-read
+        m_kick = new QTimer(this);
+        m_kick->setSingleShot(true);
+        m_kick->setInterval(50);
+        connect(m_kick, &QTimer::timeout, this, [this]() { refresh(); });
+
+        auto *watcher = new QDBusServiceWatcher(NM_SERVICE, m_bus,
+                            QDBusServiceWatcher::WatchForOwnerChange, this);
+        connect(watcher, &QDBusServiceWatcher::serviceOwnerChanged, this,
+                [this](const QString &, const QString &, const QString &owner) {
+            watchPath(m_device, QString());
+            watchPath(m_ap, QString());
+            if (owner.isEmpty()) {
+                m_available = false;
+                publish();
+            } else {
+                resolveDevice();
+            }
+        });
+
+        // PropertiesChanged lands on QTimer::start(), so no moc is needed
+        m_bus.connect(NM_SERVICE, NM_PATH, DBUS_PROPS, "PropertiesChanged",
+                      m_kick, SLOT(start()));
+        resolveDevice();
     }
 
-    // Try iw dev
-    {
-        QString cmd =
-            "if command -v iw >/dev/null 2>&1; then "
-            "iw dev wlan0 link | awk -F'ssid ' '/SSID/ {print $2}'; "
-            "fi";
+    QString text() const {
+        if (!m_available) {
+            // no NetworkManager: fall back to what the kernel reports
+            int perc = wifiQualityPercent(m_iface);
+            return (perc >= 0) ? QString("🟢 %1%").arg(perc) : QString("🔴");
+        }
+        if (!m_enabled)
+            return "🔴";
+
+        QString line1 = (m_strength >= 0)
+            ? QString("🟢 %1%").arg(m_strength)
+            : QString("🟢 ON");
 
-        QProcess p;
-        p.start("bash", {"-c", cmd});
-        p.waitForFinished(600);
-        QString ssid = QString::fromUtf8(p.readAll()).trimmed();
-        if (!ssid.isEmpty()) return ssid;
+        if (!m_ssid.isEmpty())
+            return line1 + "\n" + m_ssid;
+        return line1;
     }
 
-    // Try wpa_cli
-    {
-        QString cmd =
-            "if command -v wpa_cli >/dev/null 2>&1; then "
-            "wpa_cli status | awk -F= '/^ssid=/ {print $2}'; "
-            "fi";
+    void toggle() {
+        if (!m_available) return;
+        QDBusMessage m = QDBusMessage::createMethodCall(NM_SERVICE, NM_PATH,
+                                                        DBUS_PROPS, "Set");
+        m << QString(NM_IFACE) << QString("WirelessEnabled")
+          << QVariant::fromValue(QDBusVariant(!m_enabled));
+        m_bus.asyncCall(m);
+        // the resulting PropertiesChanged updates the card
+    }
 
-        QProcess p;
-        p.start("bash", {"-c", cmd});
-        p.waitForFinished(600);
-        QString ssid = QString::fromUtf8(p.readAll()).trimmed();
-        if (!ssid.isEmpty()) return ssid;
+private:
+    void call(const QDBusMessage &m, std::function<void(const QDBusMessage&)> done) {
+        auto *w = new QDBusPendingCallWatcher(m_bus.asyncCall(m), this);
+        connect(w, &QDBusPendingCallWatcher::finished, this, [w, done]() {
+            done(w->reply());
+            w->deleteLater();
+        });
     }
 
-    // Fallback: wpa_supplicant.conf
-    {
-        QProcess p;
-        p.start("bash", {"-c",
-            "grep -m1 '^ssid=' /etc/wpa_supplicant/wpa_supplicant.conf "
-            "2>/dev/null | cut -d'\"' -f2"});
-        p.waitForFinished(300);
-        QString ssid = QString::fromUtf8(p.readAll()).trimmed();
-        if (!ssid.isEmpty()) return ssid;
+    void getProperty(const QString &path, const char *iface, const char *name,
+                     std::function<void(const QVariant&)> done) {
+        QDBusMessage m = QDBusMessage::createMethodCall(NM_SERVICE, path,
+                                                        DBUS_PROPS, "Get");
+        m << QString(iface) << QString(name);
+        call(m, [done](const QDBusMessage &r) {
+            if (r.type() != QDBusMessage::ReplyMessage) {
+                done(QVariant());
+                return;
+            }
+            done(r.arguments().value(0).value<QDBusVariant>().variant());
+        });
     }
 
-    return QString();
-}
+    void watchPath(QString &current, const QString &path) {
+        if (current == path) return;
+        if (!current.isEmpty())
+            m_bus.disconnect(NM_SERVICE, current, DBUS_PROPS, "PropertiesChanged",
+                             m_kick, SLOT(start()));
+        current = path;
+        if (!current.isEmpty())
+            m_bus.connect(NM_SERVICE, current, DBUS_PROPS, "PropertiesChanged",
+                          m_kick, SLOT(start()));
+    }
 
-static QString wifiInfo(const QString &iface) {
-    if (!wifiOn_nm())
-        return "🔴";
+    void resolveDevice() {
+        QDBusMessage m = QDBusMessage::createMethodCall(NM_SERVICE, NM_PATH,
+                                                        NM_IFACE, "GetDeviceByIpIface");
+        m << m_iface;
+        call(m, [this](const QDBusMessage &r) {
+            QString dev;
+            if (r.type() == QDBusMessage::ReplyMessage)
+                dev = r.arguments().value(0).value<QDBusObjectPath>().path();
+            watchPath(m_device, dev);
+            refresh();
+        });
+    }
+
+    void refresh() {
+        getProperty(NM_PATH, NM_IFACE, "WirelessEnabled", [this](const QVariant &v) {
+            m_available = v.isValid();
+            m_enabled = v.toBool();
+            publish();
+        });
 
-    int perc = wifiQualityPercent(iface);
-    QString ssid = detectWifiSsid(iface);
+        if (m_device.isEmpty()) return;
 
-    QString line1 = (perc >= 0)
-        ? QString("🟢 %1%").arg(perc)
-        : QString("🟢 ON");
+        getProperty(m_device, NM_WIRELESS, "ActiveAccessPoint", [this](const QVariant &v) {
+            QString ap = v.value<QDBusObjectPath>().path();
+            if (ap == "/") ap.clear();
+            watchPath(m_ap, ap);
 
-    if (!ssid.isEmpty())
-        return line1 + "\n" + ssid;
+            if (ap.isEmpty()) {
+                m_ssid.clear();
+                m_strength = -1;
+                publish();
+                return;
+            }
 
-    return line1;
-}
+            QDBusMessage m = QDBusMessage::createMethodCall(NM_SERVICE, ap,
+                                                            DBUS_PROPS, "GetAll");
+            m << QString(NM_AP);
+            call(m, [this, ap](const QDBusMessage &r) {
+                if (ap != m_ap || r.type() != QDBusMessage::ReplyMessage)
+                    return;     // roamed meanwhile, or AP vanished
+                QVariantMap props = qdbus_cast<QVariantMap>(r.arguments().value(0));
+                m_ssid = QString::fromUtf8(props.value("Ssid").toByteArray());
+                m_strength = props.contains("Strength")
+                    ? props.value("Strength").toInt() : -1;
+                publish();
+            });
+        });
+    }
 
-static void toggleWifi_nm() {
-    bool on = wifiOn_nm();
-    QString cmd = on
-        ? "nmcli radio wifi off"
-        : "nmcli radio wifi on";
-    QProcess::startDetached("bash", {"-c", cmd});
-}
+    void publish() {
+        QString t = text();
+        if (t == m_text) return;
+        m_text = t;
+        if (onChanged) onChanged(t);
+    }
+
+    QString m_iface;
+    QDBusConnection m_bus;
+    QTimer *m_kick;
+
+    QString m_device;
+    QString m_ap;
+    bool m_available;
+    bool m_enabled;
+    QString m_ssid;
+    int m_strength;
+    QString m_text;
+};
 
 // ────────────────────────────── Ethernet
 static QString detectEthernetInterface() {
@@ -270,18 +398,6 @@ static QString detectBatteryPath() {
     return "";
 }
 
-static int batteryPercent(const QString &base) {
-    if (base.isEmpty()) return -1;
-    bool ok = false;
-    int v = readFile(base + "/capacity").toInt(&ok);
-    return ok ? v : -1;
-}
-
-static QString batteryStatus(const QString &base) {
-    if (base.isEmpty()) return "Unknown";
-    return readFile(base + "/status");
-}
-
 static QString formatHoursMinutes(double hours) {
     if (hours <= 0 || std::isnan(hours) || std::isinf(hours))
         return "Est. time: Unknown";
@@ -295,57 +411,6 @@ static QString formatHoursMinutes(double hours) {
         : QString("Est. time: %1m").arg(m);
 }
 
-static QString batteryTimeText(const QString &base) {
-    if (base.isEmpty()) return "No battery detected";
-
-    QString status = batteryStatus(base);
-
-    auto readLL = [&](const QString &p)->long long {
-        bool ok = false;
-        long long v = readFile(base + "/" + p).toLongLong(&ok);
-        return ok ? v : -1;
-    };
-
-    long long now = -1, full = -1, rate = -1;
-
-    if (QFile::exists(base + "/energy_now")) {
-        now  = readLL("energy_now");
-        full = readLL("energy_full");
-        rate = readLL("power_now");
-    } else if (QFile::exists(base + "/charge_now")) {
-        now  = readLL("charge_now");
-        full = readLL("charge_full");
-        rate = readLL("current_now");
-    }
-
-    if (now <= 0 || full <= 0 || rate <= 0)
-        return "Est. time: Unknown";
-
-    double hours = 0.0;
-    if (status == "Discharging")
-        hours = double(now) / double(rate);
-    else if (status == "Charging")
-        hours = double(full - now) / double(rate);
-    else
-        return "Est. time: Unknown";
-
-    return formatHoursMinutes(hours);
-}
-
-static QString batteryMainText(const QString &base) {
-    if (base.isEmpty()) return "No battery detected";
-    int pct = batteryPercent(base);
-    return (pct < 0) ? "Unknown" : QString("%1%").arg(pct);
-}
-
-static QString batteryStatusLine(const QString &base) {
-    if (base.isEmpty()) return "";
-    QString status = batteryStatus(base).trimmed();
-    if (status.startsWith("Charging", Qt::CaseInsensitive)) return "Charging";
-    if (status.startsWith("Full", Qt::CaseInsensitive)) return "Full";
-    return "";
-}
-
 // choose icon name based on percentage, charging, power saver
 static QString selectBatteryIconName(int pct, const QString &statusRaw, bool saver) {
     QString status = statusRaw.trimmed();
@@ -398,49 +463,1026 @@ static void togglePowerSaver() {
         "else powerprofilesctl set power-saver; fi; fi"});
 }
 
-// ──────────────────────────────  Tray items
-struct TrayEntry {
-    QString serviceName;
-    QString label;
+// ──────────────────────────────  Battery monitor
+// Battery state is re-read when the kernel announces a power_supply
+// change on the uevent netlink socket, plus a slow timer for batteries
+// that only report status transitions. "Est. time" uses an exponentially
+// smoothed rate rather than the instantaneous power_now, so one noisy
+// sample doesn't swing it by hours.
+
+class BatteryMonitor : public QObject {
+public:
+    std::function<void()> onChanged;
+
+    explicit BatteryMonitor(const QString &base, QObject *parent = nullptr)
+        : QObject(parent),
+          m_base(base),
+          m_fd(-1),
+          m_percent(-1),
+          m_now(-1),
+          m_full(-1),
+          m_rate(0),
+          m_lastSample(0),
+          m_stepLevel(-1),
+          m_stepAt(-1)
+    {
+        m_clock.start();
+
+        m_fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        NETLINK_KOBJECT_UEVENT);
+        if (m_fd >= 0) {
+            sockaddr_nl addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.nl_family = AF_NETLINK;
+            addr.nl_groups = 1;     // kernel uevent broadcast
+            if (::bind(m_fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+                ::close(m_fd);
+                m_fd = -1;
+            } else {
+                new FdNotifier(m_fd, [this]() { readUevents(); }, this);
+            }
+        }
+
+        // events arrive in bursts (battery + adapter); read sysfs once
+        m_settle = new QTimer(this);
+        m_settle->setSingleShot(true);
+        m_settle->setInterval(100);
+        connect(m_settle, &QTimer::timeout, this, [this]() { sample(); });
+
+        m_fallback = new QTimer(this);
+        m_fallback->setInterval(kFallbackMs);
+        connect(m_fallback, &QTimer::timeout, this, [this]() { sample(); });
+        m_fallback->start();
+
+        sample();
+    }
+
+    ~BatteryMonitor() override {
+        if (m_fd >= 0) ::close(m_fd);
+    }
+
+    bool present() const { return !m_base.isEmpty(); }
+    int percent() const { return m_percent; }
+    QString status() const { return m_status; }
+
+    QString mainText() const {
+        if (!present()) return "No battery detected";
+        return (m_percent < 0) ? "Unknown" : QString("%1%").arg(m_percent);
+    }
+
+    QString timeText() const {
+        if (!present()) return "No battery detected";
+        if (m_now <= 0 || m_rate <= 0) return "Est. time: Unknown";
+
+        if (m_status == "Discharging")
+            return formatHoursMinutes(m_now / m_rate);
+        if (m_status == "Charging" && m_full > m_now)
+            return formatHoursMinutes((m_full - m_now) / m_rate);
+        return "Est. time: Unknown";
+    }
+
+    QString statusLine() const {
+        if (!present()) return "";
+        if (m_status.startsWith("Charging", Qt::CaseInsensitive)) return "Charging";
+        if (m_status.startsWith("Full", Qt::CaseInsensitive)) return "Full";
+        return "";
+    }
+
+private:
+    static const int kFallbackMs = 30000;
+    static constexpr double kTauSec = 300.0;      // rate smoothing window
+
+    void readUevents() {
+        char buf[8192];
+        bool relevant = false;
+        ssize_t n;
+        while ((n = ::recv(m_fd, buf, sizeof(buf) - 1, 0)) > 0) {
+            buf[n] = 0;
+            // "ACTION@DEVPATH\0KEY=VALUE\0..."
+            for (char *p = buf; p < buf + n; p += strlen(p) + 1)
+                if (strcmp(p, "SUBSYSTEM=power_supply") == 0) {
+                    relevant = true;
+                    break;
+                }
+        }
+        if (relevant && !m_settle->isActive())
+            m_settle->start();
+    }
+
+    void sample() {
+        if (m_base.isEmpty()) return;
+
+        auto readLL = [&](const char *name) -> double {
+            bool ok = false;
+            long long v = readFile(m_base + "/" + name).toLongLong(&ok);
+            return ok ? double(v) : -1.0;
+        };
+
+        bool ok = false;
+        int pct = readFile(m_base + "/capacity").toInt(&ok);
+        QString status = readFile(m_base + "/status");
+
+        // energy (µWh, µW) or charge (µAh, µA); either way now/rate is hours
+        double now, full, inst;
+        if (QFile::exists(m_base + "/energy_now")) {
+            now  = readLL("energy_now");
+            full = readLL("energy_full");
+            inst = readLL("power_now");
+        } else {
+            now  = readLL("charge_now");
+            full = readLL("charge_full");
+            inst = readLL("current_now");
+        }
+        inst = std::fabs(inst);
+
+        qint64 t = m_clock.elapsed();
+
+        if (status != m_status) {
+            // direction changed: the old rate means nothing now
+            m_rate = 0;
+            m_lastSample = 0;
+            m_stepLevel = -1;
+            m_stepAt = -1;
+        }
+
+        // No usable power_now: derive the rate from the level's slope. The
+        // counter moves in coarse steps minutes apart, so the slope is
+        // taken between two observed steps, not between samples. The first
+        // level seen is somewhere inside a step and can't anchor one.
+        if (now > 0 && now != m_stepLevel) {
+            if (inst <= 0 && m_stepAt >= 0) {
+                double dtHours = (t - m_stepAt) / 3600000.0;
+                if (dtHours > 0)
+                    inst = std::fabs(now - m_stepLevel) / dtHours;
+            }
+            m_stepAt = (m_stepLevel > 0) ? t : -1;
+            m_stepLevel = now;
+        }
+
+        if (inst > 0) {
+            if (m_rate <= 0 || !m_lastSample) {
+                m_rate = inst;
+            } else {
+                double dt = (t - m_lastSample) / 1000.0;
+                double alpha = 1.0 - std::exp(-dt / kTauSec);
+                m_rate += alpha * (inst - m_rate);
+            }
+        }
+
+        m_lastSample = t;
+        m_percent = ok ? pct : -1;
+        m_status = status;
+        m_now = now;
+        m_full = full;
+
+        QString key = mainText() + '\n' + timeText() + '\n' + m_status;
+        if (key == m_published) return;
+        m_published = key;
+        if (onChanged) onChanged();
+    }
+
+    QString m_base;
+    int m_fd;
+    QTimer *m_settle;
+    QTimer *m_fallback;
+    QElapsedTimer m_clock;
+
+    int m_percent;
+    QString m_status;
+    double m_now;
+    double m_full;
+    double m_rate;
+    qint64 m_lastSample;
+    double m_stepLevel;     // level at the last observed step
+    qint64 m_stepAt;        // when it was seen, -1 until a real step
+    QString m_published;
 };
 
-static QList<TrayEntry> listTrayItems() {
-    QList<TrayEntry> items;
-    QDBusConnection bus = QDBusConnection::sessionBus();
-    if (!bus.isConnected()) return items;
-
-    QDBusInterface dbusIface(
-        "org.freedesktop.DBus",
-        "/org/freedesktop/DBus",
-        "org.freedesktop.DBus",
-        bus
-    );
-
-    QDBusReply<QStringList> reply = dbusIface.call("ListNames");
-    if (!reply.isValid()) return items;
-
-    const QStringList names = reply.value();
-    for (const QString &name : names) {
-        if (!name.contains("StatusNotifierItem")) continue;
-
-        QDBusInterface sni(
-            name,
-            "/StatusNotifierItem",
-            "org.kde.StatusNotifierItem",
-            bus
-        );
-        if (!sni.isValid()) continue;
+// ──────────────────────────────  Brightness
+// Applied in-process: the panel backlight through sysfs (or logind when
+// the node isn't writable by us), otherwise a scaled gamma ramp on the
+// primary CRTC, which is what `xrandr --brightness` does. set() may be
+// called on every slider tick; the hardware is touched at most once per
+// display frame.
+
+class BrightnessControl : public QObject {
+public:
+    explicit BrightnessControl(QObject *parent = nullptr)
+        : QObject(parent),
+          m_fd(-1),
+          m_max(0),
+          m_dpy(nullptr),
+          m_crtc(0),
+          m_gamma(nullptr),
+          m_pending(-1),
+          m_applied(-1)
+    {
+        if (!openBacklight())
+            openCrtc();
+
+        qreal hz = QApplication::primaryScreen()->refreshRate();
+        if (hz < 1) hz = 60;
+
+        m_frame = new QTimer(this);
+        m_frame->setSingleShot(true);
+        m_frame->setInterval(qMax(1, int(1000.0 / hz)));
+        connect(m_frame, &QTimer::timeout, this, [this]() {
+            if (m_pending == m_applied) return;
+            apply();
+            m_frame->start();
+        });
+    }
+
+    ~BrightnessControl() override {
+        if (m_fd >= 0) ::close(m_fd);
+        if (m_gamma) XRRFreeGamma(m_gamma);
+        if (m_dpy) XCloseDisplay(m_dpy);
+    }
 
-        QString label = sni.property("Title").toString();
-        if (label.isEmpty()) label = sni.property("Id").toString();
-        if (label.isEmpty()) label = name;
+    // percent 1..100; first tick applies at once, the rest once per frame
+    void set(int percent) {
+        m_pending = qBound(1, percent, 100);
+        if (m_frame->isActive()) return;
+        apply();
+        m_frame->start();
+    }
+
+    // apply whatever is still pending (slider released)
+    void flush() {
+        m_frame->stop();
+        apply();
+    }
+
+private:
+    bool openBacklight() {
+        // firmware interfaces first, as the kernel recommends
+        QDir dir("/sys/class/backlight");
+        QString best;
+        int bestRank = -1;
+        for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QString type = readFile(dir.filePath(name) + "/type");
+            int rank = (type == "firmware") ? 2 : (type == "platform") ? 1 : 0;
+            if (rank > bestRank) {
+                bestRank = rank;
+                best = name;
+            }
+        }
+        if (best.isEmpty()) return false;
+
+        m_max = readFile(dir.filePath(best) + "/max_brightness").toInt();
+        if (m_max <= 0) return false;
+
+        m_backlight = best;
+        QByteArray node = QFile::encodeName(dir.filePath(best) + "/brightness");
+        m_fd = ::open(node.constData(), O_WRONLY | O_CLOEXEC);
+        return true;
+    }
+
+    bool openCrtc() {
+        m_dpy = XOpenDisplay(nullptr);
+        if (!m_dpy) return false;
+
+        int ev, err;
+        if (!XRRQueryExtension(m_dpy, &ev, &err)) {
+            XCloseDisplay(m_dpy);
+            m_dpy = nullptr;
+            return false;
+        }
+
+        Window root = DefaultRootWindow(m_dpy);
+        XRRScreenResources *res = XRRGetScreenResourcesCurrent(m_dpy, root);
+        if (!res) {
+            XCloseDisplay(m_dpy);
+            m_dpy = nullptr;
+            return false;
+        }
+
+        QVector<RROutput> outputs;
+        outputs << XRRGetOutputPrimary(m_dpy, root);
+        for (int i = 0; i < res->noutput; i++)
+            outputs << res->outputs[i];
+
+        for (RROutput out : outputs) {
+            if (!out) continue;
+            XRROutputInfo *oi = XRRGetOutputInfo(m_dpy, res, out);
+            if (!oi) continue;
+            if (oi->connection == RR_Connected && oi->crtc)
+                m_crtc = oi->crtc;
+            XRRFreeOutputInfo(oi);
+            if (m_crtc) break;
+        }
+        XRRFreeScreenResources(res);
 
-        items.append({ name, label });
+        int size = m_crtc ? XRRGetCrtcGammaSize(m_dpy, m_crtc) : 0;
+        if (size > 1)
+            m_gamma = XRRAllocGamma(size);
+        return m_gamma != nullptr;
     }
 
-    return items;
+    void apply() {
+        if (m_pending < 0 || m_pending == m_applied) return;
+        m_applied = m_pending;
+
+        if (!m_backlight.isEmpty()) {
+            int raw = qMax(1, int(std::lround(m_max * m_applied / 100.0)));
+            if (m_fd >= 0) {
+                QByteArray v = QByteArray::number(raw);
+                if (::pwrite(m_fd, v.constData(), v.size(), 0) == v.size())
+                    return;
+            }
+            // not writable by this user: logind may set it for our session
+            QDBusMessage m = QDBusMessage::createMethodCall(
+                "org.freedesktop.login1", "/org/freedesktop/login1/session/auto",
+                "org.freedesktop.login1.Session", "SetBrightness");
+            m << QString("backlight") << m_backlight << quint32(raw);
+            QDBusConnection::systemBus().asyncCall(m);
+            return;
+        }
+
+        if (m_gamma) {
+            double f = m_applied / 100.0;
+            int n = m_gamma->size;
+            for (int i = 0; i < n; i++) {
+                double v = double(i) / (n - 1) * f * 65535.0;
+                unsigned short c = (unsigned short)qBound(0.0, v, 65535.0);
+                m_gamma->red[i] = m_gamma->green[i] = m_gamma->blue[i] = c;
+            }
+            XRRSetCrtcGamma(m_dpy, m_crtc, m_gamma);
+            XFlush(m_dpy);
+        }
+    }
+
+    QString m_backlight;
+    int m_fd;
+    int m_max;
+
+    Display *m_dpy;
+    RRCrtc m_crtc;
+    XRRCrtcGamma *m_gamma;
+
+    QTimer *m_frame;
+    int m_pending;
+    int m_applied;
+};
+
+// ──────────────────────────────  Desktop notifications (org.freedesktop.Notifications)
+// osm-notify owns the notification bus name. Notifications live in a
+// fixed set of slots: a new one takes a free slot, and only a full store
+// evicts (the oldest expired entry, else the oldest); replaces_id updates
+// its slot in place, and a single timer serves every expiry.
+// The server only records which ids changed; the overlay redraws those
+// rows at most once per frame, so a flood stays cheap.
+
+struct DesktopNotification {
+    quint32 id = 0;
+    QString app;
+    QString icon;
+    QString summary;
+    QString body;
+    QStringList actions;    // key, label, key, label, ...
+    int urgency = 1;
+    bool resident = false;
+    qint64 deadline = 0;    // server clock ms, 0 = until dismissed
+};
+
+class NotificationStore {
+public:
+    explicit NotificationStore(int capacity)
+        : m_slots(capacity), m_born(capacity, 0), m_serial(0)
+    {
+        for (int i = capacity - 1; i >= 0; --i)
+            m_free.append(i);
+    }
+
+    // returns the id evicted to make room, or 0; *expired tells whether
+    // it had already run out
+    quint32 put(const DesktopNotification &n, qint64 now, bool *expired) {
+        *expired = false;
+        auto it = m_index.constFind(n.id);
+        if (it != m_index.constEnd()) {
+            m_slots[*it] = n;
+            m_born[*it] = ++m_serial;
+            return 0;
+        }
+
+        quint32 evicted = 0;
+        int slot;
+        if (!m_free.isEmpty()) {
+            slot = m_free.takeLast();
+        } else {
+            slot = victim(now);
+            evicted = m_slots[slot].id;
+            *expired = isExpired(m_slots[slot], now);
+            m_index.remove(evicted);
+        }
+
+        m_slots[slot] = n;
+        m_born[slot] = ++m_serial;
+        m_index.insert(n.id, slot);
+        return evicted;
+    }
+
+    bool remove(quint32 id) {
+        auto it = m_index.find(id);
+        if (it == m_index.end()) return false;
+        m_slots[*it] = DesktopNotification();
+        m_free.append(*it);
+        m_index.erase(it);
+        return true;
+    }
+
+    const DesktopNotification *find(quint32 id) const {
+        auto it = m_index.constFind(id);
+        return (it == m_index.constEnd()) ? nullptr : &m_slots[*it];
+    }
+
+    qint64 nextDeadline() const {
+        qint64 next = 0;
+        for (const DesktopNotification &n : m_slots)
+            if (n.id && n.deadline && (!next || n.deadline < next))
+                next = n.deadline;
+        return next;
+    }
+
+    QList<quint32> expiredBy(qint64 now) const {
+        QList<quint32> out;
+        for (const DesktopNotification &n : m_slots)
+            if (isExpired(n, now))
+                out << n.id;
+        return out;
+    }
+
+    int size() const { return m_index.size(); }
+
+private:
+    static bool isExpired(const DesktopNotification &n, qint64 now) {
+        return n.id && n.deadline && n.deadline <= now;
+    }
+
+    // full store: the oldest expired entry, else the oldest of all
+    int victim(qint64 now) const {
+        int oldest = 0, oldestExpired = -1;
+        for (int i = 0; i < m_slots.size(); ++i) {
+            if (m_born[i] < m_born[oldest]) oldest = i;
+            if (isExpired(m_slots[i], now) &&
+                (oldestExpired < 0 || m_born[i] < m_born[oldestExpired]))
+                oldestExpired = i;
+        }
+        return oldestExpired >= 0 ? oldestExpired : oldest;
+    }
+
+    QVector<DesktopNotification> m_slots;
+    QVector<quint64> m_born;        // insertion order, per slot
+    QVector<int> m_free;
+    QHash<quint32, int> m_index;
+    quint64 m_serial;
+};
+
+class NotificationServer : public QDBusVirtualObject {
+public:
+    enum CloseReason { Expired = 1, Dismissed = 2, Closed = 3, Undefined = 4 };
+
+    static const int kCapacity = 128;
+
+    std::function<void(quint32)> onChanged;   // added, replaced or removed
+
+    explicit NotificationServer(QObject *parent = nullptr)
+        : QDBusVirtualObject(parent),
+          m_store(kCapacity),
+          m_lastId(0),
+          m_bus(QDBusConnection::sessionBus())
+    {
+        m_clock.start();
+
+        m_expiry = new QTimer(this);
+        m_expiry->setSingleShot(true);
+        connect(m_expiry, &QTimer::timeout, this, [this]() {
+            for (quint32 id : m_store.expiredBy(m_clock.elapsed()))
+                close(id, Expired);
+            rearm();
+        });
+    }
+
+    bool start() {
+        if (!m_bus.registerVirtualObject(kPath, this)) return false;
+        if (!m_bus.registerService("org.freedesktop.Notifications")) {
+            qWarning() << "osm-notify: another notification daemon owns the bus name";
+            m_bus.unregisterObject(kPath);
+            return false;
+        }
+        return true;
+    }
+
+    const DesktopNotification *find(quint32 id) const { return m_store.find(id); }
+
+    // from the panel
+    void invokeAction(quint32 id, const QString &key) {
+        const DesktopNotification *n = m_store.find(id);
+        if (!n) return;
+        bool resident = n->resident;
+        emitSignal("ActionInvoked", { id, key });
+        if (!resident) close(id, Dismissed);
+    }
+
+    void dismiss(quint32 id) { close(id, Dismissed); }
+
+    QString introspect(const QString &) const override {
+        return
+            "<interface name=\"org.freedesktop.Notifications\">"
+            "<method name=\"GetCapabilities\"><arg type=\"as\" direction=\"out\"/></method>"
+            "<method name=\"Notify\">"
+            "<arg type=\"s\" direction=\"in\"/><arg type=\"u\" direction=\"in\"/>"
+            "<arg type=\"s\" direction=\"in\"/><arg type=\"s\" direction=\"in\"/>"
+            "<arg type=\"s\" direction=\"in\"/><arg type=\"as\" direction=\"in\"/>"
+            "<arg type=\"a{sv}\" direction=\"in\"/><arg type=\"i\" direction=\"in\"/>"
+            "<arg type=\"u\" direction=\"out\"/></method>"
+            "<method name=\"CloseNotification\"><arg type=\"u\" direction=\"in\"/></method>"
+            "<method name=\"GetServerInformation\">"
+            "<arg type=\"s\" direction=\"out\"/><arg type=\"s\" direction=\"out\"/>"
+            "<arg type=\"s\" direction=\"out\"/><arg type=\"s\" direction=\"out\"/></method>"
+            "<signal name=\"NotificationClosed\"><arg type=\"u\"/><arg type=\"u\"/></signal>"
+            "<signal name=\"ActionInvoked\"><arg type=\"u\"/><arg type=\"s\"/></signal>"
+            "</interface>";
+    }
+
+    bool handleMessage(const QDBusMessage &msg, const QDBusConnection &conn) override {
+        if (!msg.interface().isEmpty() &&
+            msg.interface() != "org.freedesktop.Notifications")
+            return false;
+
+        const QString m = msg.member();
+        const QList<QVariant> a = msg.arguments();
+
+        if (m == "GetCapabilities") {
+            conn.send(msg.createReply(QStringList{ "body", "actions", "persistence" }));
+        } else if (m == "GetServerInformation") {
+            conn.send(msg.createReply(QVariantList{ "osm-notify", "Alternix", "1.0", "1.2" }));
+        } else if (m == "Notify" && a.size() == 8) {
+            conn.send(msg.createReply(notify(a)));
+        } else if (m == "CloseNotification" && a.size() == 1) {
+            close(a[0].toUInt(), Closed);
+            conn.send(msg.createReply());
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr const char *kPath = "/org/freedesktop/Notifications";
+
+    quint32 notify(const QList<QVariant> &a) {
+        DesktopNotification n;
+        quint32 replaces = a[1].toUInt();
+        n.id      = (replaces && m_store.find(replaces)) ? replaces : nextId();
+        n.app     = a[0].toString();
+        n.icon    = a[2].toString();
+        n.summary = a[3].toString();
+        n.body    = a[4].toString();
+        n.actions = a[5].toStringList();
+
+        QVariantMap hints = qdbus_cast<QVariantMap>(a[6]);
+        n.urgency  = hints.value("urgency", 1).toInt();
+        n.resident = hints.value("resident", false).toBool();
+
+        // -1 (server default) keeps it in the panel until dismissed;
+        // critical ones never expire, as the spec asks
+        int timeout = a[7].toInt();
+        if (timeout > 0 && n.urgency < 2)
+            n.deadline = m_clock.elapsed() + timeout;
+
+        bool expired;
+        quint32 evicted = m_store.put(n, m_clock.elapsed(), &expired);
+        if (evicted) {
+            emitSignal("NotificationClosed",
+                       { evicted, quint32(expired ? Expired : Undefined) });
+            if (onChanged) onChanged(evicted);
+        }
+        if (onChanged) onChanged(n.id);
+        rearm();
+        return n.id;
+    }
+
+    void close(quint32 id, CloseReason reason) {
+        if (!m_store.remove(id)) return;
+        emitSignal("NotificationClosed", { id, quint32(reason) });
+        if (onChanged) onChanged(id);
+        rearm();
+    }
+
+    quint32 nextId() {
+        if (++m_lastId == 0) ++m_lastId;   // 0 means "no id" on the wire
+        return m_lastId;
+    }
+
+    void rearm() {
+        qint64 next = m_store.nextDeadline();
+        if (!next) {
+            m_expiry->stop();
+            return;
+        }
+        m_expiry->start(int(qBound<qint64>(0, next - m_clock.elapsed(), INT_MAX)));
+    }
+
+    void emitSignal(const char *name, const QVariantList &args) {
+        QDBusMessage s = QDBusMessage::createSignal(kPath,
+                            "org.freedesktop.Notifications", name);
+        s.setArguments(args);
+        m_bus.send(s);
+    }
+
+    NotificationStore m_store;
+    quint32 m_lastId;
+    QDBusConnection m_bus;
+    QElapsedTimer m_clock;
+    QTimer *m_expiry;
+};
+
+// ──────────────────────────────  Tray items (StatusNotifierWatcher)
+// osm-notify is the StatusNotifierWatcher and host. Items register with
+// us and are dropped when their bus name goes away. Their properties and
+// dbusmenu layout are fetched asynchronously and cached, and re-fetched
+// when the item signals a change. If another watcher already owns the
+// name, we follow its item list instead, and take the name over when that
+// watcher goes away.
+
+struct TrayMenuEntry {
+    int id = 0;
+    QString label;
+    bool enabled = true;
+    bool visible = true;
+    bool separator = false;
+    QList<TrayMenuEntry> children;
+};
+
+struct TrayItem {
+    QString key;        // service + object path, as the watcher lists it
+    QString service;
+    QString path;
+    QString id;
+    QString title;
+    QString status;
+    QString menuPath;
+    QList<TrayMenuEntry> menu;
+
+    QString label() const {
+        if (!title.isEmpty()) return title;
+        if (!id.isEmpty()) return id;
+        return service;
+    }
+};
+
+static const char *SNW_SERVICE    = "org.kde.StatusNotifierWatcher";
+static const char *SNW_PATH       = "/StatusNotifierWatcher";
+static const char *SNI_IFACE      = "org.kde.StatusNotifierItem";
+static const char *DBUSMENU_IFACE = "com.canonical.dbusmenu";
+
+// (ia{sv}av) — one dbusmenu node and its children
+static TrayMenuEntry parseMenuEntry(const QDBusArgument &arg) {
+    TrayMenuEntry e;
+    QVariantMap props;
+
+    arg.beginStructure();
+    arg >> e.id >> props;
+    arg.beginArray();
+    while (!arg.atEnd()) {
+        QDBusVariant v;
+        arg >> v;
+        TrayMenuEntry child = parseMenuEntry(v.variant().value<QDBusArgument>());
+        if (child.visible) e.children << child;
+    }
+    arg.endArray();
+    arg.endStructure();
+
+    // "_" marks a mnemonic, "__" is a literal underscore
+    QString label = props.value("label").toString();
+    label.replace("__", QChar(1)).remove('_').replace(QChar(1), "_");
+
+    e.label     = label;
+    e.enabled   = props.value("enabled", true).toBool();
+    e.visible   = props.value("visible", true).toBool();
+    e.separator = props.value("type").toString() == "separator";
+    return e;
 }
 
+class TrayWatcher : public QDBusVirtualObject {
+public:
+    std::function<void(const QString&)> onChanged;   // key added, updated or removed
+
+    explicit TrayWatcher(QObject *parent = nullptr)
+        : QDBusVirtualObject(parent),
+          m_bus(QDBusConnection::sessionBus()),
+          m_owner(false)
+    {
+        m_names = new QDBusServiceWatcher(this);
+        m_names->setConnection(m_bus);
+        m_names->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+        connect(m_names, &QDBusServiceWatcher::serviceUnregistered, this,
+                [this](const QString &service) { dropService(service); });
+
+        m_resync = new QTimer(this);
+        m_resync->setSingleShot(true);
+        m_resync->setInterval(50);
+        connect(m_resync, &QTimer::timeout, this, [this]() { followWatcher(); });
+
+        // while following: claim the name once its owner exits, or follow
+        // whoever takes it over instead
+        m_watcherOwner = new QDBusServiceWatcher(SNW_SERVICE, m_bus,
+                             QDBusServiceWatcher::WatchForOwnerChange, this);
+        connect(m_watcherOwner, &QDBusServiceWatcher::serviceOwnerChanged, this,
+                [this](const QString &, const QString &, const QString &) {
+                    if (m_owner || !m_following) return;
+                    unfollow();
+                    start();
+                });
+    }
+
+    void start() {
+        if (!m_bus.isConnected()) return;
+
+        m_bus.registerVirtualObject(SNW_PATH, this);
+        m_owner = m_bus.registerService(SNW_SERVICE);
+        if (m_owner) {
+            // items watch for the watcher and (re-)register themselves;
+            // the ones we mirrored from a previous owner are ours now
+            emitSignal("StatusNotifierHostRegistered", {});
+            for (const QString &key : m_items.keys())
+                emitSignal("StatusNotifierItemRegistered", { key });
+            return;
+        }
+
+        m_bus.unregisterObject(SNW_PATH);
+        m_host = QString("org.kde.StatusNotifierHost-%1").arg(getpid());
+        m_bus.registerService(m_host);
+
+        QDBusMessage reg = QDBusMessage::createMethodCall(SNW_SERVICE, SNW_PATH,
+                                SNW_SERVICE, "RegisterStatusNotifierHost");
+        reg << m_host;
+        m_bus.asyncCall(reg);
+
+        // zero-arg slot: any change just triggers a re-read of the list
+        m_bus.connect(SNW_SERVICE, SNW_PATH, SNW_SERVICE,
+                      "StatusNotifierItemRegistered", m_resync, SLOT(start()));
+        m_bus.connect(SNW_SERVICE, SNW_PATH, SNW_SERVICE,
+                      "StatusNotifierItemUnregistered", m_resync, SLOT(start()));
+        m_following = true;
+        followWatcher();
+    }
+
+    const TrayItem *item(const QString &key) const {
+        auto it = m_items.constFind(key);
+        return (it == m_items.constEnd()) ? nullptr : &it.value();
+    }
+
+    void activateMenuEntry(const QString &key, int id) {
+        const TrayItem *it = item(key);
+        if (!it || it->menuPath.isEmpty()) return;
+        QDBusMessage m = QDBusMessage::createMethodCall(it->service, it->menuPath,
+                                                        DBUSMENU_IFACE, "Event");
+        m << id << QString("clicked") << QVariant::fromValue(QDBusVariant(QString()))
+          << quint32(QDateTime::currentSecsSinceEpoch());
+        m_bus.asyncCall(m);
+    }
+
+    void contextMenu(const QString &key) {
+        const TrayItem *it = item(key);
+        if (!it) return;
+        QDBusMessage m = QDBusMessage::createMethodCall(it->service, it->path,
+                                                        SNI_IFACE, "ContextMenu");
+        m << 0 << 0;
+        m_bus.asyncCall(m);
+    }
+
+    QString introspect(const QString &) const override {
+        return
+            "<interface name=\"org.kde.StatusNotifierWatcher\">"
+            "<method name=\"RegisterStatusNotifierItem\"><arg type=\"s\" direction=\"in\"/></method>"
+            "<method name=\"RegisterStatusNotifierHost\"><arg type=\"s\" direction=\"in\"/></method>"
+            "<property name=\"RegisteredStatusNotifierItems\" type=\"as\" access=\"read\"/>"
+            "<property name=\"IsStatusNotifierHostRegistered\" type=\"b\" access=\"read\"/>"
+            "<property name=\"ProtocolVersion\" type=\"i\" access=\"read\"/>"
+            "<signal name=\"StatusNotifierItemRegistered\"><arg type=\"s\"/></signal>"
+            "<signal name=\"StatusNotifierItemUnregistered\"><arg type=\"s\"/></signal>"
+            "<signal name=\"StatusNotifierHostRegistered\"/>"
+            "</interface>";
+    }
+
+    bool handleMessage(const QDBusMessage &msg, const QDBusConnection &conn) override {
+        const QString iface = msg.interface();
+        const QString m = msg.member();
+        const QList<QVariant> a = msg.arguments();
+
+        if (iface == DBUS_PROPS) {
+            if (m == "Get" && a.size() == 2) {
+                conn.send(msg.createReply(
+                    QVariant::fromValue(QDBusVariant(properties().value(a[1].toString())))));
+                return true;
+            }
+            if (m == "GetAll") {
+                conn.send(msg.createReply(properties()));
+                return true;
+            }
+            return false;
+        }
+
+        if (!iface.isEmpty() && iface != SNW_SERVICE)
+            return false;
+
+        if (m == "RegisterStatusNotifierItem" && a.size() == 1) {
+            // either a bus name, or an object path on the caller's connection
+            QString arg = a[0].toString();
+            QString service = msg.service();
+            QString path = "/StatusNotifierItem";
+            if (arg.startsWith('/')) path = arg;
+            else if (!arg.isEmpty()) service = arg;
+
+            addItem(service, path);
+            conn.send(msg.createReply());
+            return true;
+        }
+        if (m == "RegisterStatusNotifierHost" && a.size() == 1) {
+            conn.send(msg.createReply());
+            return true;
+        }
+        return false;
+    }
+
+private:
+    QVariantMap properties() const {
+        return {
+            { "RegisteredStatusNotifierItems", QStringList(m_items.keys()) },
+            { "IsStatusNotifierHostRegistered", true },
+            { "ProtocolVersion", 0 },
+        };
+    }
+
+    void call(const QDBusMessage &m, std::function<void(const QDBusMessage&)> done) {
+        auto *w = new QDBusPendingCallWatcher(m_bus.asyncCall(m), this);
+        connect(w, &QDBusPendingCallWatcher::finished, this, [w, done]() {
+            done(w->reply());
+            w->deleteLater();
+        });
+    }
+
+    void emitSignal(const char *name, const QVariantList &args) {
+        QDBusMessage s = QDBusMessage::createSignal(SNW_PATH, SNW_SERVICE, name);
+        s.setArguments(args);
+        m_bus.send(s);
+    }
+
+    void addItem(const QString &service, const QString &path) {
+        QString key = service + path;
+        if (m_items.contains(key)) return;
+
+        TrayItem it;
+        it.key = key;
+        it.service = service;
+        it.path = path;
+        m_items.insert(key, it);
+        m_names->addWatchedService(service);
+
+        // the item's change signals funnel into one coalesced re-fetch
+        QTimer *kick = new QTimer(this);
+        kick->setSingleShot(true);
+        kick->setInterval(50);
+        connect(kick, &QTimer::timeout, this, [this, key]() { fetchItem(key); });
+        m_kicks.insert(key, kick);
+
+        for (const char *sig : { "NewTitle", "NewIcon", "NewStatus", "NewToolTip", "NewMenu" })
+            m_bus.connect(service, path, SNI_IFACE, sig, kick, SLOT(start()));
+
+        if (m_owner) emitSignal("StatusNotifierItemRegistered", { key });
+        fetchItem(key);
+    }
+
+    void removeItem(const QString &key) {
+        if (!m_items.remove(key)) return;
+        // QtDBus drops the signal hooks along with their receiver
+        delete m_kicks.take(key);
+        if (m_owner) emitSignal("StatusNotifierItemUnregistered", { key });
+        if (onChanged) onChanged(key);
+    }
+
+    void dropService(const QString &service) {
+        m_names->removeWatchedService(service);
+        for (const QString &key : m_items.keys())
+            if (m_items.value(key).service == service)
+                removeItem(key);
+    }
+
+    void fetchItem(const QString &key) {
+        const TrayItem *it = item(key);
+        if (!it) return;
+
+        QDBusMessage m = QDBusMessage::createMethodCall(it->service, it->path,
+                                                        DBUS_PROPS, "GetAll");
+        m << QString(SNI_IFACE);
+        call(m, [this, key](const QDBusMessage &r) {
+            auto it = m_items.find(key);
+            if (it == m_items.end()) return;
+
+            if (r.type() == QDBusMessage::ReplyMessage) {
+                QVariantMap p = qdbus_cast<QVariantMap>(r.arguments().value(0));
+                it->id     = p.value("Id").toString();
+                it->title  = p.value("Title").toString();
+                it->status = p.value("Status").toString();
+
+                QString menu = p.value("Menu").value<QDBusObjectPath>().path();
+                if (menu == "/") menu.clear();
+                if (menu != it->menuPath) {
+                    QTimer *kick = m_kicks.value(key);
+                    if (!it->menuPath.isEmpty())
+                        hookMenu(it->service, it->menuPath, kick, false);
+                    it->menuPath = menu;
+                    it->menu.clear();
+                    if (!menu.isEmpty())
+                        hookMenu(it->service, menu, kick, true);
+                }
+                if (!it->menuPath.isEmpty())
+                    fetchMenu(key);
+            }
+            if (onChanged) onChanged(key);
+        });
+    }
+
+    void hookMenu(const QString &service, const QString &menu, QTimer *kick, bool on) {
+        for (const char *sig : { "LayoutUpdated", "ItemsPropertiesUpdated" }) {
+            if (on) m_bus.connect(service, menu, DBUSMENU_IFACE, sig, kick, SLOT(start()));
+            else    m_bus.disconnect(service, menu, DBUSMENU_IFACE, sig, kick, SLOT(start()));
+        }
+    }
+
+    void fetchMenu(const QString &key) {
+        const TrayItem *it = item(key);
+        if (!it || it->menuPath.isEmpty()) return;
+
+        // lets apps that build menus lazily fill in the root first
+        QDBusMessage prep = QDBusMessage::createMethodCall(it->service, it->menuPath,
+                                                           DBUSMENU_IFACE, "AboutToShow");
+        prep << 0;
+        m_bus.asyncCall(prep);
+
+        QDBusMessage m = QDBusMessage::createMethodCall(it->service, it->menuPath,
+                                                        DBUSMENU_IFACE, "GetLayout");
+        m << 0 << -1 << QStringList{ "label", "enabled", "visible", "type" };
+        call(m, [this, key](const QDBusMessage &r) {
+            auto it = m_items.find(key);
+            if (it == m_items.end() || r.type() != QDBusMessage::ReplyMessage) return;
+            if (r.arguments().size() < 2) return;
+
+            TrayMenuEntry root = parseMenuEntry(
+                r.arguments().at(1).value<QDBusArgument>());
+            it->menu = root.children;
+            if (onChanged) onChanged(key);
+        });
+    }
+
+    void unfollow() {
+        m_bus.disconnect(SNW_SERVICE, SNW_PATH, SNW_SERVICE,
+                         "StatusNotifierItemRegistered", m_resync, SLOT(start()));
+        m_bus.disconnect(SNW_SERVICE, SNW_PATH, SNW_SERVICE,
+                         "StatusNotifierItemUnregistered", m_resync, SLOT(start()));
+        m_bus.unregisterService(m_host);
+        m_resync->stop();
+        m_following = false;
+    }
+
+    // another watcher owns the name: mirror its RegisteredStatusNotifierItems
+    void followWatcher() {
+        QDBusMessage m = QDBusMessage::createMethodCall(SNW_SERVICE, SNW_PATH,
+                                                        DBUS_PROPS, "Get");
+        m << QString(SNW_SERVICE) << QString("RegisteredStatusNotifierItems");
+        call(m, [this](const QDBusMessage &r) {
+            // a late reply from a watcher we no longer follow
+            if (!m_following || r.type() != QDBusMessage::ReplyMessage) return;
+            QStringList entries =
+                r.arguments().value(0).value<QDBusVariant>().variant().toStringList();
+
+            QSet<QString> seen;
+            for (const QString &e : entries) {
+                int slash = e.indexOf('/');
+                QString service = (slash < 0) ? e : e.left(slash);
+                QString path = (slash < 0) ? QString("/StatusNotifierItem") : e.mid(slash);
+                seen.insert(service + path);
+                addItem(service, path);
+            }
+            for (const QString &key : m_items.keys())
+                if (!seen.contains(key))
+                    removeItem(key);
+        });
+    }
+
+    QDBusConnection m_bus;
+    bool m_owner;
+    bool m_following = false;
+    QString m_host;
+    QDBusServiceWatcher *m_names;
+    QDBusServiceWatcher *m_watcherOwner;
+    QTimer *m_resync;
+    QMap<QString, TrayItem> m_items;
+    QHash<QString, QTimer*> m_kicks;
+};
+
 // ──────────────────────────────  Clickable icon
 class ClickIcon : public QLabel {
 public:
@@ -489,6 +1531,127 @@ protected:
     }
 };
 
+// ──────────────────────────────  Desktop notification row
+class NotificationRow : public QFrame {
+public:
+    std::function<void(const QString&)> onAction;
+    std::function<void()> onDismiss;
+
+    explicit NotificationRow(QWidget *parent = nullptr)
+        : QFrame(parent)
+    {
+        setStyleSheet("QFrame { background:#40000000; border-radius:12px; }"
+                      "QLabel { background:transparent; }");
+
+        QVBoxLayout *v = new QVBoxLayout(this);
+        v->setContentsMargins(10, 6, 6, 6);
+        v->setSpacing(2);
+
+        QHBoxLayout *top = new QHBoxLayout();
+        top->setSpacing(8);
+
+        m_icon = new QLabel(this);
+        m_icon->setFixedSize(24, 24);
+
+        m_summary = new QLabel(this);
+        m_summary->setTextFormat(Qt::PlainText);
+        m_summary->setStyleSheet("color:white; font-size:14pt; font-weight:bold;");
+
+        QPushButton *close = new QPushButton("✕", this);
+        close->setFixedSize(32, 32);
+        close->setStyleSheet("QPushButton { background:transparent; color:#bbbbbb;"
+                             " font-size:14pt; border:none; }");
+        QObject::connect(close, &QPushButton::clicked, this, [this]() {
+            if (onDismiss) onDismiss();
+        });
+
+        top->addWidget(m_icon);
+        top->addWidget(m_summary, 1);
+        top->addWidget(close);
+
+        m_body = new QLabel(this);
+        m_body->setTextFormat(Qt::PlainText);
+        m_body->setWordWrap(true);
+        m_body->setStyleSheet("color:#dddddd; font-size:12pt;");
+
+        m_actionRow = new QHBoxLayout();
+        m_actionRow->setSpacing(8);
+
+        v->addLayout(top);
+        v->addWidget(m_body);
+        v->addLayout(m_actionRow);
+    }
+
+    void setNotification(const DesktopNotification &n) {
+        m_summary->setText(n.summary.isEmpty() ? n.app : n.summary);
+        m_body->setText(n.body);
+        m_body->setVisible(!n.body.isEmpty());
+
+        if (n.icon != m_iconName) {
+            m_iconName = n.icon;
+            QPixmap px;
+            if (n.icon.startsWith('/') || n.icon.startsWith("file://"))
+                px.load(QUrl(n.icon).isLocalFile() ? QUrl(n.icon).toLocalFile() : n.icon);
+            else if (!n.icon.isEmpty())
+                px = QIcon::fromTheme(n.icon).pixmap(24, 24);
+            m_icon->setPixmap(px.isNull() ? QPixmap()
+                              : px.scaled(24, 24, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+            m_icon->setVisible(!px.isNull());
+        }
+
+        if (n.actions != m_actions) {
+            m_actions = n.actions;
+            rebuildActions();
+        }
+    }
+
+protected:
+    void mouseReleaseEvent(QMouseEvent *e) override {
+        // tapping the row is the "default" action when the sender offers one
+        if (e->button() == Qt::LeftButton && onAction) {
+            for (int i = 0; i + 1 < m_actions.size(); i += 2)
+                if (m_actions[i] == "default") {
+                    onAction("default");
+                    break;
+                }
+        }
+        QFrame::mouseReleaseEvent(e);
+    }
+
+private:
+    void rebuildActions() {
+        while (QLayoutItem *it = m_actionRow->takeAt(0)) {
+            delete it->widget();
+            delete it;
+        }
+
+        for (int i = 0; i + 1 < m_actions.size(); i += 2) {
+            const QString key = m_actions[i];
+            if (key == "default") continue;
+
+            QPushButton *b = new QPushButton(m_actions[i + 1], this);
+            b->setMinimumHeight(32);
+            b->setStyleSheet(
+                "QPushButton { background:#80708099; border-radius:16px;"
+                " padding:4px 14px; color:white; font-size:12pt; }"
+                "QPushButton:pressed { background:#282828; border:1px solid #ffffff; }"
+            );
+            QObject::connect(b, &QPushButton::clicked, this, [this, key]() {
+                if (onAction) onAction(key);
+            });
+            m_actionRow->addWidget(b);
+        }
+        m_actionRow->addStretch();
+    }
+
+    QLabel *m_icon;
+    QLabel *m_summary;
+    QLabel *m_body;
+    QHBoxLayout *m_actionRow;
+    QString m_iconName;
+    QStringList m_actions;
+};
+
 // ──────────────────────────────  Clickable card frame
 class ClickableCard : public QFrame {
 public:
@@ -557,12 +1720,29 @@ public:
     QMap<ClickLabel*, QList<QWidget*>> submenuMap;
 
     QList<QWidget*> orderedWidgets;
-    QMap<QWidget*, QRect> finalGeomMap;
-    QMap<QWidget*, QGraphicsOpacityEffect*> opacityMap;
+
+    // open/close animate pixmaps of the cards, not the live widgets
+    QList<QPixmap> snapshots;
+    QList<QRect> snapshotRects;
+    QVariantAnimation *snapAnim;
+    bool snapOpening;
+    double snapT;
     bool closing;
 
-    QTimer *refreshTimer;
-    bool refreshEnabled;
+    BatteryMonitor *battery;
+    bool powerSaver;
+
+    WifiMonitor *wifi;
+
+    NotificationServer *notifServer;
+    QVBoxLayout *desktopNotifLayout;
+    QHash<quint32, NotificationRow*> notifRows;
+    QSet<quint32> dirtyNotifs;
+    QTimer *notifFlush;
+    int trayCount;
+
+    TrayWatcher *tray;
+    QHash<QString, ClickLabel*> trayRows;
 
     NotificationOverlay()
         : QWidget(),
@@ -579,8 +1759,17 @@ public:
           batteryIconLabel(nullptr),
           notifListLayout(nullptr),
           closing(false),
-          refreshTimer(nullptr),
-          refreshEnabled(false)
+          snapAnim(nullptr),
+          snapOpening(false),
+          snapT(0),
+          battery(nullptr),
+          powerSaver(false),
+          wifi(nullptr),
+          notifServer(nullptr),
+          desktopNotifLayout(nullptr),
+          notifFlush(nullptr),
+          trayCount(0),
+          tray(nullptr)
     {
         setWindowFlags(Qt::FramelessWindowHint
                        | Qt::WindowStaysOnTopHint
@@ -602,25 +1791,14 @@ public:
         QString ethIF  = detectEthernetInterface();
         QString batPath = detectBatteryPath();
 
+        // battery labels follow BatteryMonitor; this only re-reads the
+        // toggled card while its service settles
         auto scheduleRefresh = [=](QLabel *infoLabel,
                                    std::function<QString()> infoFunc)
         {
             auto performUpdate = [=]() {
                 if (infoLabel && infoFunc)
                     infoLabel->setText(infoFunc());
-
-                if (!batPath.isEmpty()) {
-                    if (batteryInfoLabel)
-                        batteryInfoLabel->setText(batteryMainText(batPath));
-                    if (batteryTimeLabel)
-                        batteryTimeLabel->setText(batteryTimeText(batPath));
-                    if (batteryStatusLabel) {
-                        QString st = batteryStatusLine(batPath);
-                        batteryStatusLabel->setText(st);
-                        batteryStatusLabel->setVisible(!st.isEmpty());
-                    }
-                }
-                const_cast<NotificationOverlay*>(this)->updateBatteryIconColor();
             };
 
             QTimer::singleShot(100,  this, performUpdate);
@@ -628,6 +1806,10 @@ public:
             QTimer::singleShot(1500, this, performUpdate);
         };
 
+        battery = new BatteryMonitor(batPath, this);
+        battery->onChanged = [this]() { applyBatteryState(); };
+        powerSaver = isPowerSaver();
+
         // ───────── Clock Card
         {
             QHBoxLayout *topInner = new QHBoxLayout();
@@ -681,7 +1863,7 @@ public:
             auto addToggle =
                 [&](const QString &icon, const QString &labelText,
                     std::function<QString()> infoFunc,
-                    std::function<void()> toggleFunc)
+                    std::function<void()> toggleFunc) -> QLabel*
             {
                 QVBoxLayout *inner = new QVBoxLayout();
                 inner->setAlignment(Qt::AlignCenter);
@@ -713,12 +1895,18 @@ public:
                 int c = toggleIndex % sysCols;
                 grid->addWidget(card, r, c);
                 toggleIndex++;
+                return info;
             };
 
-            // Wi-Fi
-            addToggle("wifi.png", "Wi-Fi",
-                      [wifiIF]() { return wifiInfo(wifiIF); },
-                      []() { toggleWifi_nm(); });
+            // Wi-Fi: pushed by NetworkManager, never polled
+            wifi = new WifiMonitor(wifiIF, this);
+            QLabel *wifiLabel =
+                addToggle("wifi.png", "Wi-Fi",
+                          [this]() { return wifi->text(); },
+                          [this]() { wifi->toggle(); });
+            wifi->onChanged = [wifiLabel](const QString &t) {
+                wifiLabel->setText(t);
+            };
 
             // Bluetooth
             addToggle("bt.png", "Bluetooth",
@@ -748,18 +1936,18 @@ public:
                 lbl->setStyleSheet("color:white; font-size:18pt;");
                 lbl->setAlignment(Qt::AlignCenter);
 
-                batteryInfoLabel = new QLabel(batteryMainText(batPath), this);
+                batteryInfoLabel = new QLabel(battery->mainText(), this);
                 batteryInfoLabel->setStyleSheet("color:#dddddd; font-size:14pt;");
                 batteryInfoLabel->setAlignment(Qt::AlignCenter);
 
-                batteryTimeLabel = new QLabel(batteryTimeText(batPath), this);
+                batteryTimeLabel = new QLabel(battery->timeText(), this);
                 batteryTimeLabel->setStyleSheet("color:#cccccc; font-size:14pt;");
                 batteryTimeLabel->setAlignment(Qt::AlignCenter);
 
-                batteryStatusLabel = new QLabel(batteryStatusLine(batPath), this);
+                batteryStatusLabel = new QLabel(battery->statusLine(), this);
                 batteryStatusLabel->setStyleSheet("color:#cccccc; font-size:14pt;");
                 batteryStatusLabel->setAlignment(Qt::AlignCenter);
-                batteryStatusLabel->setVisible(!batteryStatusLine(batPath).isEmpty());
+                batteryStatusLabel->setVisible(!battery->statusLine().isEmpty());
 
                 inner->addWidget(batteryIconLabel);
                 inner->addWidget(lbl);
@@ -767,19 +1955,9 @@ public:
                 inner->addWidget(batteryTimeLabel);
                 inner->addWidget(batteryStatusLabel);
 
-                // shared updater for delayed refresh after toggling saver
-                auto refreshBatteryUI = [this, batPath]() {
-                    if (!batPath.isEmpty()) {
-                        if (batteryInfoLabel)
-                            batteryInfoLabel->setText(batteryMainText(batPath));
-                        if (batteryTimeLabel)
-                            batteryTimeLabel->setText(batteryTimeText(batPath));
-                        if (batteryStatusLabel) {
-                            QString st = batteryStatusLine(batPath);
-                            batteryStatusLabel->setText(st);
-                            batteryStatusLabel->setVisible(!st.isEmpty());
-                        }
-                    }
+                // only the icon depends on the saver profile
+                auto refreshSaver = [this]() {
+                    powerSaver = isPowerSaver();
                     updateBatteryIconColor();
                 };
 
@@ -787,12 +1965,9 @@ public:
                     // Toggle power saver profile
                     togglePowerSaver();
 
-                    // Give powerprofilesctl time to update:
-                    //  - first quick refresh at 150ms
-                    //  - second more relaxed refresh at 500ms
-                    QTimer::singleShot(100, this, refreshBatteryUI);
-                    QTimer::singleShot(500, this, refreshBatteryUI);
-                    QTimer::singleShot(1000, this, refreshBatteryUI);
+                    // Give powerprofilesctl time to update
+                    QTimer::singleShot(150, this, refreshSaver);
+                    QTimer::singleShot(1000, this, refreshSaver);
                 };
 
                 QFrame *batCard = createCard(this, inner, true, onClick);
@@ -810,7 +1985,7 @@ public:
             updateBatteryIconColor();
         }
 
-        // ───────── Brightness Card  (XRANDR VERSION)
+        // ───────── Brightness Card
         {
             QVBoxLayout *bInner = new QVBoxLayout();
             bInner->setAlignment(Qt::AlignCenter);
@@ -819,24 +1994,6 @@ public:
             bLabel->setStyleSheet("color:white; font-size:18pt; font-weight:bold;");
             bLabel->setAlignment(Qt::AlignCenter);
 
-            auto detectPrimaryOutput = []() -> QString {
-                QProcess p;
-                p.start("bash", {"-c",
-                    "xrandr | awk '/ primary/{print $1; exit}'"});
-                p.waitForFinished(100);
-                QString out = QString::fromUtf8(p.readAll()).trimmed();
-                if (out.isEmpty()) {
-                    p.start("bash", {"-c",
-                        "xrandr | awk '/ connected/{print $1; exit}'"});
-                    p.waitForFinished(100);
-                    out = QString::fromUtf8(p.readAll()).trimmed();
-                }
-                return out;
-            };
-
-            QString output = detectPrimaryOutput();
-            if (output.isEmpty()) output = "HDMI-1";
-
             int savedBrightness = 80;
             {
                 QSettings s("Alternix", "osm-notify");
@@ -856,24 +2013,27 @@ public:
                 " outline:none; border:0px solid transparent; }"
             );
 
-            {
-                double factor = savedBrightness / 100.0;
-                QString cmd = QString("xrandr --output %1 --brightness %2")
-                                .arg(output)
-                                .arg(QString::number(factor, 'f', 2));
-                QProcess::startDetached("bash", {"-c", cmd});
-            }
-
-            QObject::connect(slider, &QSlider::valueChanged, this,
-                             [output](int v) {
-                double factor = v / 100.0;
-                QString cmd = QString("xrandr --output %1 --brightness %2")
-                                .arg(output)
-                                .arg(QString::number(factor, 'f', 2));
-                QProcess::startDetached("bash", {"-c", cmd});
+            // sysfs backlight or CRTC gamma, once per frame at most
+            auto *bright = new BrightnessControl(this);
+            bright->set(savedBrightness);
 
+            auto saveBrightness = [](int v) {
                 QSettings s("Alternix", "osm-notify");
                 s.setValue("brightness", v);
+            };
+
+            QObject::connect(slider, &QSlider::valueChanged, this,
+                             [bright, slider, saveBrightness](int v) {
+                bright->set(v);
+                // clicks and keys move it without a press/release pair
+                if (!slider->isSliderDown())
+                    saveBrightness(v);
+            });
+
+            QObject::connect(slider, &QSlider::sliderReleased, this,
+                             [bright, slider, saveBrightness]() {
+                bright->flush();
+                saveBrightness(slider->value());
             });
 
             bInner->addWidget(bLabel);
@@ -911,25 +2071,14 @@ public:
 
             notifScroll->setWidget(scrollContent);
 
-            QList<TrayEntry> trayItems = listTrayItems();
-            bool hasEntries = !trayItems.isEmpty();
-
-            for (const TrayEntry &te : trayItems) {
-                ClickLabel *row = new ClickLabel(
-                    QString("• %1").arg(te.label),
-                    te.serviceName,
-                    scrollContent
-                );
-
-                row->onClick = [this, row]() {
-                    toggleSubmenu(row);
-                };
-
-                notifListLayout->addWidget(row);
-            }
+            // desktop notifications above the tray entries, newest first
+            desktopNotifLayout = new QVBoxLayout();
+            desktopNotifLayout->setContentsMargins(0,0,0,6);
+            desktopNotifLayout->setSpacing(6);
+            notifListLayout->addLayout(desktopNotifLayout);
 
-            if (!hasEntries)
-                notifScroll->hide();
+            // tray rows arrive from TrayWatcher as items register
+            notifScroll->hide();
 
             notifInner->addWidget(notifScroll);
 
@@ -938,6 +2087,28 @@ public:
             main->addWidget(card);
         }
 
+        // ───────── Notification server (rows redrawn in batches)
+        notifFlush = new QTimer(this);
+        notifFlush->setSingleShot(true);
+        QObject::connect(notifFlush, &QTimer::timeout, this, [this]() {
+            flushNotifications();
+        });
+
+        notifServer = new NotificationServer(this);
+        notifServer->onChanged = [this](quint32 id) {
+            dirtyNotifs.insert(id);
+            if (!notifFlush->isActive())
+                notifFlush->start(isVisible() ? 16 : 250);
+        };
+        notifServer->start();
+
+        // ───────── Tray (StatusNotifierWatcher)
+        tray = new TrayWatcher(this);
+        tray->onChanged = [this](const QString &key) {
+            updateTrayRow(key);
+        };
+        tray->start();
+
         main->addStretch();
 
         orderedWidgets.clear();
@@ -946,40 +2117,28 @@ public:
                        << brightnessCardWidget
                        << notifCardWidget;
 
+        // hidden cards keep their slot, so snapshots line up with the
+        // live layout and the swap at the end doesn't move anything
         for (QWidget *w : orderedWidgets) {
-            if (w) w->setVisible(false);
+            if (!w) continue;
+            QSizePolicy sp = w->sizePolicy();
+            sp.setRetainSizeWhenHidden(true);
+            w->setSizePolicy(sp);
+            w->setVisible(false);
         }
-
-        // ───────── Controlled periodic refresh (battery etc.)
-        refreshTimer = new QTimer(this);
-        refreshTimer->setInterval(500);   // 500ms global refresh
-        QObject::connect(refreshTimer, &QTimer::timeout, this, [=]() {
-            if (!refreshEnabled) return;
-            if (!this->isVisible()) return;
-
-            if (!batPath.isEmpty()) {
-                if (batteryInfoLabel)
-                    batteryInfoLabel->setText(batteryMainText(batPath));
-                if (batteryTimeLabel)
-                    batteryTimeLabel->setText(batteryTimeText(batPath));
-                if (batteryStatusLabel) {
-                    QString st = batteryStatusLine(batPath);
-                    batteryStatusLabel->setText(st);
-                    batteryStatusLabel->setVisible(!st.isEmpty());
-                }
-            }
-            updateBatteryIconColor();
-        });
     }
 
     void openPanel() {
         if (closing) return;
 
-        if (refreshTimer) {
-            refreshEnabled = false;
-            refreshTimer->stop();
+        if (notifFlush && notifFlush->isActive()) {
+            notifFlush->stop();
+            flushNotifications();
         }
 
+        // the profile can change behind our back; one read per open
+        powerSaver = isPowerSaver();
+
         if (isVisible()) {
             hide();
             lower();
@@ -988,12 +2147,7 @@ public:
         closing = false;
 
         for (QWidget *w : orderedWidgets) {
-            if (!w) continue;
-            if (auto *eff =
-                    qobject_cast<QGraphicsOpacityEffect*>(w->graphicsEffect())) {
-                eff->setOpacity(0.0);
-            }
-            w->setVisible(false);
+            if (w) w->setVisible(false);
         }
 
         showFullScreen();
@@ -1004,187 +2158,138 @@ public:
     void playOpenAnimation() {
         updateBatteryIconColor();
 
-        const double startScale = 0.3;
-
-        for (QWidget *w : orderedWidgets) {
-            if (w) w->setVisible(true);
-        }
-
-        finalGeomMap.clear();
-
-        for (QWidget *w : orderedWidgets) {
-            if (!w) continue;
-
-            QRect endRect = w->geometry();
-            if (!endRect.isValid()) continue;
+        takeSnapshots();
+        runSnapshotAnimation(true, [this]() {
+            for (QWidget *w : orderedWidgets)
+                if (w) w->setVisible(true);
+        });
+    }
 
-            finalGeomMap[w] = endRect;
+    void animatedClose() {
+        if (closing) return;
+        closing = true;
 
-            QGraphicsOpacityEffect *eff =
-                qobject_cast<QGraphicsOpacityEffect*>(w->graphicsEffect());
-            if (!eff) {
-                eff = new QGraphicsOpacityEffect(w);
-                w->setGraphicsEffect(eff);
-            }
-            eff->setOpacity(0.0);
-            opacityMap[w] = eff;
+        takeSnapshots();
+        runSnapshotAnimation(false, [this]() {
+            closing = false;
 
-            int newW = qMax(1, int(endRect.width() * startScale));
-            int newH = qMax(1, int(endRect.height() * startScale));
-            QPoint c = endRect.center();
-            QRect startRect(c.x() - newW/2, c.y() - newH/2, newW, newH);
+            hide();
+            lower();
+            setVisible(false);
+            setEnabled(true);
 
-            w->setGeometry(startRect);
-        }
+            QTimer::singleShot(10, this, [this]() {
+                this->repaint();
+            });
+        });
+    }
 
-        // Sequential cascade, but faster than the original
-        QSequentialAnimationGroup *seq = new QSequentialAnimationGroup(this);
+    // Grab every card once at its laid-out position and hide the live
+    // widget; until the animation ends only these pixmaps are painted.
+    void takeSnapshots() {
+        snapshots.clear();
+        snapshotRects.clear();
 
         for (QWidget *w : orderedWidgets) {
             if (!w) continue;
-
-            QGraphicsOpacityEffect *eff = opacityMap.value(w, nullptr);
-            if (!eff) continue;
-
-            QParallelAnimationGroup *par = new QParallelAnimationGroup(seq);
-
-            QPropertyAnimation *gAnim = new QPropertyAnimation(w, "geometry");
-            gAnim->setDuration(80); // was 110
-            gAnim->setStartValue(w->geometry());
-            gAnim->setEndValue(finalGeomMap[w]);
-            gAnim->setEasingCurve(QEasingCurve::OutCubic);
-
-            QPropertyAnimation *oAnim = new QPropertyAnimation(eff, "opacity");
-            oAnim->setDuration(70); // was 100
-            oAnim->setStartValue(0.0);
-            oAnim->setEndValue(1.0);
-            oAnim->setEasingCurve(QEasingCurve::OutQuad);
-
-            par->addAnimation(gAnim);
-            par->addAnimation(oAnim);
-
-            seq->addAnimation(par);
-            seq->addPause(10); // was 20
+            snapshotRects << w->geometry();
+            snapshots << w->grab();
+            w->setVisible(false);
         }
-
-        QObject::connect(seq, &QSequentialAnimationGroup::finished,
-                         this, [this]() {
-            if (refreshTimer) {
-                refreshEnabled = true;
-                refreshTimer->start();
-            }
-        });
-
-        seq->start(QAbstractAnimation::DeleteWhenStopped);
     }
-    void animatedClose() {
-        if (closing) return;
-        closing = true;
 
-        if (refreshTimer) {
-            refreshEnabled = false;
-            refreshTimer->stop();
+    // Same cascade as before (scale from 0.3 about the centre plus a fade,
+    // one card after another), driven by one clock and drawn in paintEvent.
+    void runSnapshotAnimation(bool opening, std::function<void()> done) {
+        if (snapAnim) {
+            snapAnim->stop();
+            snapAnim->deleteLater();
         }
 
-        const double endScale = 0.3;
-
-        if (finalGeomMap.isEmpty()) {
-            for (QWidget *w : orderedWidgets) {
-                if (w && w->geometry().isValid())
-                    finalGeomMap[w] = w->geometry();
-            }
-        }
+        snapOpening = opening;
+        snapT = 0;
 
-        QList<QWidget*> closeOrder = orderedWidgets;
-        std::reverse(closeOrder.begin(), closeOrder.end());
+        int n = snapshots.size();
+        int total = qMax(1, (n - 1) * snapStaggerMs() + snapCardMs());
 
-        // Sequential close (reverse order), faster than original
-        QSequentialAnimationGroup *seq = new QSequentialAnimationGroup(this);
+        snapAnim = new QVariantAnimation(this);
+        snapAnim->setStartValue(0.0);
+        snapAnim->setEndValue(double(total));
+        snapAnim->setDuration(total);
 
-        for (QWidget *w : closeOrder) {
-            if (!w) continue;
+        QObject::connect(snapAnim, &QVariantAnimation::valueChanged, this,
+                         [this](const QVariant &v) {
+            snapT = v.toDouble();
+            update();
+        });
+        QObject::connect(snapAnim, &QVariantAnimation::finished, this,
+                         [this, done]() {
+            snapAnim->deleteLater();
+            snapAnim = nullptr;
+            snapshots.clear();
+            snapshotRects.clear();
+            done();
+            update();
+        });
 
-            QRect baseRect = finalGeomMap.value(w, w->geometry());
-            if (!baseRect.isValid()) continue;
+        update();
+        snapAnim->start();
+    }
 
-            QGraphicsOpacityEffect *eff = opacityMap.value(w, nullptr);
-            if (!eff) {
-                eff = new QGraphicsOpacityEffect(w);
-                w->setGraphicsEffect(eff);
-                eff->setOpacity(1.0);
-                opacityMap[w] = eff;
+    int snapCardMs() const    { return snapOpening ? 80 : 70; }
+    int snapStaggerMs() const { return snapOpening ? 90 : 78; }
+
+    void paintSnapshots(QPainter &p) {
+        static const QEasingCurve scaleIn(QEasingCurve::OutCubic);
+        static const QEasingCurve fadeIn(QEasingCurve::OutQuad);
+        static const QEasingCurve scaleOut(QEasingCurve::InCubic);
+        static const QEasingCurve fadeOut(QEasingCurve::InQuad);
+
+        const int n = snapshots.size();
+        for (int i = 0; i < n; i++) {
+            // opening cascades top-down, closing bottom-up
+            int order = snapOpening ? i : n - 1 - i;
+            double t = qBound(0.0, (snapT - order * snapStaggerMs()) / snapCardMs(), 1.0);
+
+            double scale, opacity;
+            if (snapOpening) {
+                scale   = 0.3 + 0.7 * scaleIn.valueForProgress(t);
+                opacity = fadeIn.valueForProgress(qMin(1.0, t * 8.0 / 7.0));
+            } else {
+                scale   = 1.0 - 0.7 * scaleOut.valueForProgress(t);
+                opacity = 1.0 - fadeOut.valueForProgress(qMin(1.0, t * 7.0 / 6.0));
             }
+            if (opacity <= 0.0) continue;
 
-            int newW = qMax(1, int(baseRect.width() * endScale));
-            int newH = qMax(1, int(baseRect.height() * endScale));
-            QPoint c = baseRect.center();
-            QRect small(c.x() - newW/2, c.y() - newH/2, newW, newH);
-
-            QParallelAnimationGroup *par = new QParallelAnimationGroup(seq);
-
-            QPropertyAnimation *gAnim = new QPropertyAnimation(w, "geometry");
-            gAnim->setDuration(70); // was 100
-            gAnim->setStartValue(w->geometry());
-            gAnim->setEndValue(small);
-            gAnim->setEasingCurve(QEasingCurve::InCubic);
-
-            QPropertyAnimation *oAnim = new QPropertyAnimation(eff, "opacity");
-            oAnim->setDuration(60); // was 90
-            oAnim->setStartValue(eff->opacity());
-            oAnim->setEndValue(0.0);
-            oAnim->setEasingCurve(QEasingCurve::InQuad);
+            QRectF r = snapshotRects[i];
+            QSizeF sz(r.width() * scale, r.height() * scale);
+            QRectF target(r.center() - QPointF(sz.width() / 2, sz.height() / 2), sz);
 
-            par->addAnimation(gAnim);
-            par->addAnimation(oAnim);
-
-            seq->addAnimation(par);
-            seq->addPause(8); // was 15
+            p.setOpacity(opacity);
+            p.drawPixmap(target, snapshots[i], QRectF(snapshots[i].rect()));
         }
+        p.setOpacity(1.0);
+    }
 
-        QObject::connect(seq, &QSequentialAnimationGroup::finished,
-            this, [this]() {
-
-            for (QWidget *w : orderedWidgets) {
-                if (!w) continue;
-
-                QRect r = finalGeomMap.value(w);
-                if (r.isValid())
-                    w->setGeometry(r);
-
-                if (auto *eff = qobject_cast<QGraphicsOpacityEffect*>(w->graphicsEffect()))
-                    eff->setOpacity(0.0);
-
-                w->setVisible(false);
-            }
-
-            closing = false;
-
-            hide();
-            lower();
-            setVisible(false);
-            setEnabled(true);
-
-            QTimer::singleShot(10, this, [this]() {
-                this->repaint();
-            });
-        });
-
-        seq->start(QAbstractAnimation::DeleteWhenStopped);
+    void applyBatteryState() {
+        if (batteryInfoLabel)
+            batteryInfoLabel->setText(battery->mainText());
+        if (batteryTimeLabel)
+            batteryTimeLabel->setText(battery->timeText());
+        if (batteryStatusLabel) {
+            QString st = battery->statusLine();
+            batteryStatusLabel->setText(st);
+            batteryStatusLabel->setVisible(!st.isEmpty());
+        }
+        updateBatteryIconColor();
     }
 
     // ──────────────────────────────  Update battery icon from icons
     void updateBatteryIconColor() {
-        if (!batteryIconLabel) return;
-
-        QString batPath = detectBatteryPath();
-        if (batPath.isEmpty()) return;
+        if (!batteryIconLabel || !battery || !battery->present()) return;
 
-        int pct = batteryPercent(batPath);
-        QString rawStatus = batteryStatus(batPath);
-        QString status = rawStatus.trimmed();
-        bool saver = isPowerSaver();
-
-        QString iconName = selectBatteryIconName(pct, status, saver);
+        QString iconName = selectBatteryIconName(battery->percent(),
+                                                 battery->status(), powerSaver);
         QString fullPath = QDir::homePath() + "/.config/qtile/images/" + iconName;
 
         QPixmap px(fullPath);
@@ -1197,6 +2302,75 @@ public:
         }
     }
 
+    // Apply the latest state of every notification touched since the last
+    // flush; ids that came and went within one batch cost nothing.
+    void flushNotifications() {
+        if (!notifServer || !desktopNotifLayout) return;
+
+        for (quint32 id : qAsConst(dirtyNotifs)) {
+            const DesktopNotification *n = notifServer->find(id);
+            NotificationRow *row = notifRows.value(id, nullptr);
+
+            if (!n) {
+                if (row) {
+                    notifRows.remove(id);
+                    desktopNotifLayout->removeWidget(row);
+                    row->hide();
+                    row->deleteLater();
+                }
+                continue;
+            }
+
+            if (!row) {
+                row = new NotificationRow(notifScroll->widget());
+                row->onAction = [this, id](const QString &key) {
+                    notifServer->invokeAction(id, key);
+                };
+                row->onDismiss = [this, id]() {
+                    notifServer->dismiss(id);
+                };
+                desktopNotifLayout->insertWidget(0, row);
+                notifRows.insert(id, row);
+            }
+            row->setNotification(*n);
+        }
+        dirtyNotifs.clear();
+
+        notifScroll->setVisible(trayCount > 0 || !notifRows.isEmpty());
+    }
+
+    void updateTrayRow(const QString &key) {
+        if (!notifListLayout) return;
+
+        const TrayItem *it = tray->item(key);
+        ClickLabel *row = trayRows.value(key, nullptr);
+
+        // Passive items ask not to be shown
+        if (!it || it->status == "Passive") {
+            if (row) {
+                if (submenuMap.contains(row))
+                    toggleSubmenu(row);
+                trayRows.remove(key);
+                notifListLayout->removeWidget(row);
+                row->hide();
+                row->deleteLater();
+            }
+        } else if (!row) {
+            row = new ClickLabel(QString("• %1").arg(it->label()), key,
+                                 notifScroll->widget());
+            row->onClick = [this, row]() {
+                toggleSubmenu(row);
+            };
+            notifListLayout->addWidget(row);
+            trayRows.insert(key, row);
+        } else {
+            row->setText(QString("• %1").arg(it->label()));
+        }
+
+        trayCount = trayRows.size();
+        notifScroll->setVisible(trayCount > 0 || !notifRows.isEmpty());
+    }
+
     void toggleSubmenu(ClickLabel *label) {
         if (!notifListLayout || !label) return;
 
@@ -1217,40 +2391,57 @@ public:
         }
         if (idx < 0) return;
 
+        const QString key = label->serviceName;
+        const TrayItem *item = tray ? tray->item(key) : nullptr;
+
         QWidget *container = new QWidget(this);
-        QHBoxLayout *h = new QHBoxLayout(container);
-        h->setContentsMargins(32,4,4,4);
-        h->setSpacing(8);
-
-        QPushButton *btnMenu = new QPushButton("Open menu", container);
-        btnMenu->setMinimumHeight(32);
-        btnMenu->setStyleSheet(
-            "QPushButton { background:#80708099; border-radius:16px;"
-            " padding:6px 16px; color:white; font-size:12pt; }"
-            "QPushButton:hover { background:#282828; border:none; }"
-            "QPushButton:pressed { background:#282828; border:1px solid #ffffff; }"
-        );
+        QVBoxLayout *v = new QVBoxLayout(container);
+        v->setContentsMargins(32,4,4,4);
+        v->setSpacing(6);
+
+        auto addButton = [&](const QString &text, bool enabled,
+                             std::function<void()> onClicked) {
+            QPushButton *btn = new QPushButton(text, container);
+            btn->setMinimumHeight(32);
+            btn->setEnabled(enabled);
+            btn->setStyleSheet(
+                "QPushButton { background:#80708099; border-radius:16px;"
+                " padding:6px 16px; color:white; font-size:12pt; text-align:left; }"
+                "QPushButton:hover { background:#282828; border:none; }"
+                "QPushButton:pressed { background:#282828; border:1px solid #ffffff; }"
+                "QPushButton:disabled { color:#888888; }"
+            );
+            QObject::connect(btn, &QPushButton::clicked, this, onClicked);
+            v->addWidget(btn);
+        };
+
+        // cached dbusmenu layout: no round-trip when the row is tapped
+        std::function<void(const QList<TrayMenuEntry>&, const QString&)> addEntries =
+            [&](const QList<TrayMenuEntry> &entries, const QString &prefix) {
+            for (const TrayMenuEntry &e : entries) {
+                if (e.separator || e.label.isEmpty()) continue;
+                if (!e.children.isEmpty()) {
+                    addEntries(e.children, prefix + e.label + " › ");
+                    continue;
+                }
+                int id = e.id;
+                addButton(prefix + e.label, e.enabled, [this, key, id]() {
+                    if (tray) tray->activateMenuEntry(key, id);
+                    animatedClose();
+                });
+            }
+        };
 
-        h->addWidget(btnMenu);
-        h->addStretch();
+        if (item && !item->menu.isEmpty()) {
+            addEntries(item->menu, QString());
+        } else {
+            addButton("Open menu", true, [this, key]() {
+                if (tray) tray->contextMenu(key);
+            });
+        }
 
         notifListLayout->insertWidget(idx+1, container);
         submenuMap[label] = { container };
-
-        QObject::connect(btnMenu, &QPushButton::clicked, this, [label]() {
-            QDBusConnection bus = QDBusConnection::sessionBus();
-            if (!bus.isConnected()) return;
-
-            QDBusInterface sni(
-                label->serviceName,
-                "/StatusNotifierItem",
-                "org.kde.StatusNotifierItem",
-                bus
-            );
-            if (!sni.isValid()) return;
-
-            sni.call("ContextMenu", 0, 0);
-        });
     }
 
 protected:
@@ -1273,6 +2464,9 @@ protected:
         bottom.setColorAt(0.5, QColor(0,0,0,255));
         bottom.setColorAt(1, QColor(0,0,0,255));
         p.fillRect(0,h-fadeH*2,w,fadeH*2, bottom);
+
+        if (!snapshots.isEmpty())
+            paintSnapshots(p);
     }
 
     void mousePressEvent(QMouseEvent *e) override {
@@ -1311,106 +2505,13 @@ protected:
     }
 };
 
-// ──────────────────────────────  Activation edge bar (swipe-only)
-class ActivationEdgeBar : public QWidget {
-public:
-    NotificationOverlay *overlay;
-    bool dragging;
-    QPoint pressPos;
-
-    explicit ActivationEdgeBar(NotificationOverlay *ov,
-                               int x, int y, int w, int h,
-                               QWidget *parent = nullptr)
-        : QWidget(parent),
-          overlay(ov),
-          dragging(false)
-    {
-        setWindowFlags(Qt::FramelessWindowHint
-                       | Qt::WindowStaysOnTopHint
-                       | Qt::BypassWindowManagerHint
-                       | Qt::WindowDoesNotAcceptFocus);
-        setAttribute(Qt::WA_TranslucentBackground);
-        setAttribute(Qt::WA_NoSystemBackground);
-        setMouseTracking(true);
-
-        setGeometry(x, y, w, h);
-        setStyleSheet("background: rgba(0,0,0,0);");
-
-        show();
-        raise();
-    }
-
-protected:
-    void mousePressEvent(QMouseEvent *e) override {
-        if (e->button() == Qt::LeftButton) {
-            dragging = true;
-            pressPos = e->globalPos();
-        }
-        QWidget::mousePressEvent(e);
-    }
-
-    void mouseMoveEvent(QMouseEvent *e) override {
-        if (!dragging) {
-            QWidget::mouseMoveEvent(e);
-            return;
-        }
-
-        int dy = e->globalY() - pressPos.y();
-        if (dy > 12) {  // swipe threshold
-            if (overlay) {
-                overlay->openPanel();
-            }
-            dragging = false;
-        }
-
-        QWidget::mouseMoveEvent(e);
-    }
-
-    void mouseReleaseEvent(QMouseEvent *e) override {
-        dragging = false;
-        QWidget::mouseReleaseEvent(e);
-    }
-
-    void paintEvent(QPaintEvent *) override {
-        // fully invisible
-    }
-};
-
 // ──────────────────────────────  main
 int main(int argc, char **argv) {
     QApplication a(argc, argv);
 
     NotificationOverlay overlay;
 
-    QRect g = QApplication::primaryScreen()->geometry();
-    int W = g.width();
-    int barHeight = 50;
-
-    double edgeFrac   = 0.18;  // left & right exclusion
-    double centerFrac = 0.14;  // center (clock) exclusion
-
-    int edgeExclusion   = static_cast<int>(W * edgeFrac);
-    int centerExclusion = static_cast<int>(W * centerFrac);
-
-    int maxExcl = W / 3;
-    edgeExclusion   = qMin(edgeExclusion,   maxExcl);
-    centerExclusion = qMin(centerExclusion, maxExcl);
-
-    int usableWidth = W - 2 * edgeExclusion - centerExclusion;
-
-    if (usableWidth <= 20) {
-        int barWidth = W * 0.5;
-        int x = g.x() + (W - barWidth) / 2;
-        new ActivationEdgeBar(&overlay, x, g.y(), barWidth, barHeight);
-    } else {
-        int swipeWidth = usableWidth / 2;
-
-        int leftSwipeX = g.x() + edgeExclusion;
-        new ActivationEdgeBar(&overlay, leftSwipeX, g.y(), swipeWidth, barHeight);
-
-        int rightSwipeX = leftSwipeX + swipeWidth + centerExclusion;
-        new ActivationEdgeBar(&overlay, rightSwipeX, g.y(), swipeWidth, barHeight);
-    }
+    EdgeListener edge("osm-notify", &overlay, [&overlay]() { overlay.openPanel(); });
 
     return a.exec();
 }
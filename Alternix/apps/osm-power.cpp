@@ -9,10 +9,23 @@
 #include <QDateTime>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QProcess>
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QAction>
+#include <QDBusConnection>
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "common/osmtrace.h"
 
 class PowerMenuWindow : public QWidget {
 public:
@@ -21,7 +34,9 @@ public:
           panel(nullptr),
           helloLabel(nullptr),
           timeLabel(nullptr),
-          statsPanel(nullptr)
+          statsPanel(nullptr),
+          clockTimer(nullptr),
+          tracePaint(false)
     {
         // Fullscreen, no decorations, overlay-style
         setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
@@ -109,16 +124,35 @@ public:
 
         panelLayout->addWidget(statsPanel);
 
-        // Timer to update clock every second
-        QTimer *timer = new QTimer(this);
-        connect(timer, &QTimer::timeout, this, &PowerMenuWindow::updateClock);
-        timer->start(1000);
+        // Timer to update clock every second (only while shown)
+        clockTimer = new QTimer(this);
+        connect(clockTimer, &QTimer::timeout, this, &PowerMenuWindow::updateClock);
         updateClock();
 
         updateStyles();
     }
 
+    // Resident mode: everything is built already, so this is one frame.
+    void showMenu() {
+        tracePaint = true;
+        updateClock();
+        showFullScreen();
+        raise();
+        activateWindow();
+    }
+
 protected:
+    void showEvent(QShowEvent *event) override {
+        updateClock();
+        clockTimer->start(1000);
+        QWidget::showEvent(event);
+    }
+
+    void hideEvent(QHideEvent *event) override {
+        clockTimer->stop();
+        QWidget::hideEvent(event);
+    }
+
     void paintEvent(QPaintEvent *event) override {
         Q_UNUSED(event);
         QPainter p(this);
@@ -126,6 +160,11 @@ protected:
 
         // Dim background overlay
         p.fillRect(rect(), QColor(0, 0, 0, 160));
+
+        if (tracePaint) {
+            tracePaint = false;
+            trace("first-paint");
+        }
     }
 
     void resizeEvent(QResizeEvent *event) override {
@@ -210,6 +249,8 @@ private:
     QLabel *helloLabel;
     QLabel *timeLabel;
     QWidget *statsPanel;
+    QTimer *clockTimer;
+    bool tracePaint;    // next paint is the first since showMenu()
 
     QWidget* createIconButton(const QString &labelText, const QString &iconPath) {
         QWidget *wrapper = new QWidget(this);
@@ -266,36 +307,133 @@ private:
 
 private slots:
     void doLock() {
+        trace("choice", 'i', "lock");
         QProcess::startDetached("osm-lockd", QStringList());
         close();
     }
 
     void doSleep() {
+        trace("choice", 'i', "sleep");
+        trace("systemctl-suspend");
         QProcess::startDetached("systemctl", QStringList() << "suspend");
         close();
     }
 
     void doReboot() {
+        trace("choice", 'i', "reboot");
         QProcess::startDetached("systemctl", QStringList() << "reboot");
         close();
     }
 
     void doPowerOff() {
+        trace("choice", 'i', "poweroff");
         QProcess::startDetached("systemctl", QStringList() << "poweroff");
         close();
     }
 
 };
 
+// ────────────────────────────────
+// Resident mode
+// ────────────────────────────────
+// `osm-power --daemon` starts hidden with the window already built and
+// listens on $XDG_RUNTIME_DIR/osm-power.sock. osm-powerd (or a plain
+// `osm-power`) only has to write "show".
+
+static QByteArray socketPath() {
+    QByteArray dir = qgetenv("XDG_RUNTIME_DIR");
+    if (dir.isEmpty())
+        dir = "/run/user/" + QByteArray::number(getuid());
+    return dir + "/osm-power.sock";
+}
+
+// Talk to a resident instance without bringing up Qt. With msg == nullptr
+// this only checks that one is listening.
+static bool sendToResident(const QByteArray &path, const char *msg) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.constData(), sizeof(addr.sun_path) - 1);
+
+    bool ok = ::connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+    if (ok && msg)
+        ok = send(fd, msg, strlen(msg), MSG_NOSIGNAL) == ssize_t(strlen(msg));
+    close(fd);
+    return ok;
+}
+
 // ────────────────────────────────
 // main
 // ────────────────────────────────
 int main(int argc, char *argv[]) {
+    bool resident = (argc > 1 && strcmp(argv[1], "--daemon") == 0);
+    QByteArray path = socketPath();
+
+    // already resident: one write instead of a Qt cold start
+    if (sendToResident(path, resident ? nullptr : "show\n"))
+        return 0;
+
+    traceOpen("osm-power");
+
+    // a cold start: first-paint minus this is the Qt start-up cost
+    if (!resident)
+        trace("cold-start");
+
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QApplication app(argc, argv);
 
     PowerMenuWindow w;
-    w.showFullScreen();
+
+    if (!resident) {
+        w.showMenu();
+        return app.exec();
+    }
+
+    // hidden between presses; close() only hides
+    app.setQuitOnLastWindowClosed(false);
+
+    QLocalServer::removeServer(QString::fromLocal8Bit(path));
+    QLocalServer server;
+    if (!server.listen(QString::fromLocal8Bit(path))) {
+        qWarning() << "osm-power: cannot listen on" << path << server.errorString();
+        return 1;
+    }
+
+    QObject::connect(&server, &QLocalServer::newConnection, [&server, &w]() {
+        while (QLocalSocket *s = server.nextPendingConnection()) {
+            QObject::connect(s, &QLocalSocket::disconnected, s, &QObject::deleteLater);
+            QObject::connect(s, &QLocalSocket::readyRead, [s, &w]() {
+                while (s->canReadLine()) {
+                    if (s->readLine().trimmed() == "show") {
+                        trace("show-received");
+                        w.showMenu();
+                    }
+                }
+            });
+        }
+    });
+
+    // logind's PrepareForSleep(b): true going down, false on resume. No
+    // moc here, so a checkable QAction's setChecked(bool) slot takes the
+    // argument and toggled() turns it into the "asleep" span.
+    QAction sleepState(nullptr);
+    sleepState.setCheckable(true);
+    QObject::connect(&sleepState, &QAction::toggled, [](bool asleep) {
+        trace("asleep", asleep ? 'B' : 'E');
+    });
+    QDBusConnection::systemBus().connect(
+        "org.freedesktop.login1", "/org/freedesktop/login1",
+        "org.freedesktop.login1.Manager", "PrepareForSleep",
+        &sleepState, SLOT(setChecked(bool)));
+
+    // pre-warm native window, style, fonts and icons before the first press
+    w.ensurePolished();
+    w.winId();
+    w.grab();
 
     return app.exec();
 }
@@ -5,9 +5,16 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <linux/input.h>
+#include <linux/netlink.h>
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #include <cstdlib>
+#include <ctime>
+#include <csignal>
 #include <pwd.h>
 #include <grp.h>
 #include <errno.h>
@@ -15,7 +22,11 @@
 #include <ctype.h>
 #include <sys/types.h>
 
+#include "common/osmtrace.h"
+
 static const int MAX_EVENTS = 32;
+static const int VOLUME_STEP = 5;       // percent
+static const int BRIGHTNESS_STEP = 5;   // percent of max_brightness
 
 struct MonitoredDevice {
     int fd;
@@ -24,6 +35,52 @@ struct MonitoredDevice {
     bool grabbed;
 };
 
+// ---------------------------------------------------------------------------
+// Key → action table. Everything osm-powerd reacts to is listed here;
+// a device is opened only if it can produce at least one of these.
+
+enum class Action {
+    PowerMenu,
+    VolumeUp,
+    VolumeDown,
+    VolumeMute,
+    BrightnessUp,
+    BrightnessDown,
+    LidClosed,
+    LidOpened,
+};
+
+// input_event.value masks: keys are 1 press / 2 repeat / 0 release,
+// switches 1 on / 0 off
+static const unsigned OFF     = 1u << 0;
+static const unsigned ON      = 1u << 1;
+static const unsigned PRESS   = 1u << 1;
+static const unsigned REPEAT  = 1u << 2;
+
+struct Binding {
+    uint16_t    type;
+    uint16_t    code;
+    unsigned    values;
+    Action      action;
+    bool        grabbedOnly;   // only from the exclusively grabbed device
+    const char *label;
+};
+
+static const Binding BINDINGS[] = {
+    // Only the real ACPI "Power Button" may open osm-power, so Intel
+    // Virtual Buttons / F10 can't act as a power key.
+    { EV_KEY, KEY_POWER,          PRESS | REPEAT, Action::PowerMenu,      true,  "power"           },
+    { EV_KEY, KEY_VOLUMEUP,       PRESS | REPEAT, Action::VolumeUp,       false, "volume-up"       },
+    { EV_KEY, KEY_VOLUMEDOWN,     PRESS | REPEAT, Action::VolumeDown,     false, "volume-down"     },
+    { EV_KEY, KEY_MUTE,           PRESS,          Action::VolumeMute,     false, "mute"            },
+    { EV_KEY, KEY_BRIGHTNESSUP,   PRESS | REPEAT, Action::BrightnessUp,   false, "brightness-up"   },
+    { EV_KEY, KEY_BRIGHTNESSDOWN, PRESS | REPEAT, Action::BrightnessDown, false, "brightness-down" },
+    { EV_SW,  SW_LID,             ON,             Action::LidClosed,      false, "lid-closed"      },
+    { EV_SW,  SW_LID,             OFF,            Action::LidOpened,      false, "lid-opened"      },
+};
+
+// ---------------------------------------------------------------------------
+
 // Read the input device name
 std::string getDeviceName(int fd) {
     char name[256] = {0};
@@ -32,18 +89,24 @@ std::string getDeviceName(int fd) {
     return std::string(name);
 }
 
-// Check if the device supports KEY_POWER
-bool deviceHasPowerKey(int fd) {
-    unsigned long bitmask[KEY_MAX / (8 * sizeof(long)) + 1];
-    memset(bitmask, 0, sizeof(bitmask));
-
-    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(bitmask)), bitmask) < 0)
-        return false;
-
-    int idx   = KEY_POWER / (8 * sizeof(long));
-    int shift = KEY_POWER % (8 * sizeof(long));
-
-    return (bitmask[idx] & (1UL << shift)) != 0;
+// Check if the device can produce any event in BINDINGS
+bool deviceHasBoundCode(int fd) {
+    unsigned long keys[KEY_MAX / (8 * sizeof(long)) + 1];
+    unsigned long sws[SW_MAX / (8 * sizeof(long)) + 1];
+    memset(keys, 0, sizeof(keys));
+    memset(sws, 0, sizeof(sws));
+
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    ioctl(fd, EVIOCGBIT(EV_SW, sizeof(sws)), sws);
+
+    for (const Binding &b : BINDINGS) {
+        const unsigned long *bits = (b.type == EV_KEY) ? keys : sws;
+        int idx   = b.code / (8 * sizeof(long));
+        int shift = b.code % (8 * sizeof(long));
+        if (bits[idx] & (1UL << shift))
+            return true;
+    }
+    return false;
 }
 
 // Try to find an "active" logged-in user via /run/user/<uid>
@@ -137,22 +200,17 @@ passwd* getTargetUserPw() {
     return rootPw;
 }
 
-// Run osm-power as the target user (drop privileges in the child)
-void run_osm_power_as_user() {
-    passwd *pw = getTargetUserPw();
-    if (!pw) {
-        std::cerr << "osm-powerd: no valid target user, not starting osm-power\n";
-        _exit(1);
-    }
+// In a forked child: become the session user, with a clean signal mask
+// (the parent blocks SIGCHLD for its signalfd) and that user's HOME, USER
+// and XDG_RUNTIME_DIR. Returns false if the uid could not be dropped.
+bool become_user(passwd *pw) {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
 
     uid_t uid = pw->pw_uid;
     gid_t gid = pw->pw_gid;
 
-    std::cerr << "osm-powerd: dropping to user "
-              << pw->pw_name << " (uid=" << uid
-              << ", gid=" << gid << ")\n";
-
-    // Fix environment to look like that user
     setenv("HOME", pw->pw_dir, 1);
     setenv("USER", pw->pw_name, 1);
     setenv("LOGNAME", pw->pw_name, 1);
@@ -163,137 +221,501 @@ void run_osm_power_as_user() {
         setenv("XDG_RUNTIME_DIR", xdg.c_str(), 1);
     }
 
-    // Drop privileges
     if (initgroups(pw->pw_name, gid) != 0) {
         perror("initgroups");
     }
     if (setgid(gid) != 0) {
         perror("setgid");
+        return false;
     }
     if (setuid(uid) != 0) {
         perror("setuid");
+        return false;
     }
+    return getuid() == uid && geteuid() == uid;
+}
+
+// Run osm-power as the target user (drop privileges in the child)
+void run_osm_power_as_user() {
+    passwd *pw = getTargetUserPw();
+    if (!pw) {
+        std::cerr << "osm-powerd: no valid target user, not starting osm-power\n";
+        _exit(1);
+    }
+
+    std::cerr << "osm-powerd: dropping to user "
+              << pw->pw_name << " (uid=" << pw->pw_uid
+              << ", gid=" << pw->pw_gid << ")\n";
+
+    if (!become_user(pw))
+        _exit(1);
 
-    // At this point, getuid() should be the user; env has HOME/USER set.
     execlp("osm-power", "osm-power", (char*)nullptr);
     perror("execlp osm-power");
     _exit(1);
 }
 
-int main() {
-    std::vector<MonitoredDevice> devices;
+// Ask the resident osm-power (started with --daemon in the user's
+// session) to show its menu. Returns false if none is listening.
+bool show_resident_osm_power(uid_t uid) {
+    std::string path = "/run/user/" + std::to_string(uid) + "/osm-power.sock";
 
-    // Scan event0..event39
-    for (int i = 0; i < 40; i++) {
-        std::string path = "/dev/input/event" + std::to_string(i);
-        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
-        if (fd < 0)
-            continue;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
 
-        std::string name = getDeviceName(fd);
-        bool hasPowerKey = deviceHasPowerKey(fd);
-        bool isPowerName = (name.find("Power Button") != std::string::npos);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    bool ok = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+              send(fd, "show\n", 5, MSG_NOSIGNAL) == 5;
+    close(fd);
+    return ok;
+}
 
-        bool monitor = false;
-        bool grab    = false;
+// ---------------------------------------------------------------------------
+// Volume goes to the user's default sink, PipeWire (wpctl) or PulseAudio
+// (pactl), with amixer as the plain-ALSA fallback. It runs in a child that
+// has already dropped to the session user: no mixer library, ALSA config
+// or plugin ever loads as root, and the keys follow whatever output the
+// user's sound server routes to.
+
+static std::string volume_script(Action a) {
+    std::string step = std::to_string(VOLUME_STEP) + "%";
+    switch (a) {
+    case Action::VolumeUp:
+        return "{ wpctl set-mute @DEFAULT_AUDIO_SINK@ 0 && wpctl set-volume -l 1.0 @DEFAULT_AUDIO_SINK@ " + step + "+; } 2>/dev/null"
+               " || { pactl set-sink-mute @DEFAULT_SINK@ 0 && pactl set-sink-volume @DEFAULT_SINK@ +" + step + "; } 2>/dev/null"
+               " || amixer -q sset Master " + step + "+ unmute";
+    case Action::VolumeDown:
+        return "wpctl set-volume @DEFAULT_AUDIO_SINK@ " + step + "- 2>/dev/null"
+               " || pactl set-sink-volume @DEFAULT_SINK@ -" + step + " 2>/dev/null"
+               " || amixer -q sset Master " + step + "-";
+    default:
+        return "wpctl set-mute @DEFAULT_AUDIO_SINK@ toggle 2>/dev/null"
+               " || pactl set-sink-mute @DEFAULT_SINK@ toggle 2>/dev/null"
+               " || amixer -q sset Master toggle";
+    }
+}
 
-        // Any device with KEY_POWER or "Power Button" in name is interesting,
-        // BUT we will only *trigger* osm-power from the grabbed one.
-        if (hasPowerKey || isPowerName) {
-            monitor = true;
+void run_volume_as_user(uid_t uid, Action a) {
+    passwd *pw = getpwuid(uid);
+    if (!pw || !become_user(pw))
+        _exit(1);
+
+    std::string script = volume_script(a);
+    execl("/bin/sh", "sh", "-c", script.c_str(), (char*)nullptr);
+    perror("execl /bin/sh");
+    _exit(1);
+}
+
+// ---------------------------------------------------------------------------
+// Panel backlight through sysfs; osm-powerd runs setuid root, so no
+// helper process is needed.
+
+struct Backlight {
+    int  fd = -1;          // brightness
+    int  powerFd = -1;     // bl_power
+    long max = 0;
+    bool probed = false;
+
+    static long readLong(const std::string &path) {
+        FILE *f = fopen(path.c_str(), "re");
+        if (!f) return -1;
+        long v = -1;
+        if (fscanf(f, "%ld", &v) != 1) v = -1;
+        fclose(f);
+        return v;
+    }
+
+    // firmware interfaces first, as the kernel recommends
+    bool open() {
+        if (probed) return fd >= 0;
+        probed = true;
+
+        DIR *dir = opendir("/sys/class/backlight");
+        if (!dir) return false;
+
+        std::string best;
+        int bestRank = -1;
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            if (ent->d_name[0] == '.') continue;
+            std::string base = std::string("/sys/class/backlight/") + ent->d_name;
+
+            char type[32] = {0};
+            FILE *f = fopen((base + "/type").c_str(), "re");
+            if (f) {
+                if (!fgets(type, sizeof(type), f)) type[0] = '\0';
+                fclose(f);
+            }
+            int rank = !strncmp(type, "firmware", 8) ? 2 : !strncmp(type, "platform", 8) ? 1 : 0;
+            if (rank > bestRank) {
+                bestRank = rank;
+                best = base;
+            }
         }
+        closedir(dir);
+        if (best.empty()) return false;
+
+        max = readLong(best + "/max_brightness");
+        fd = ::open((best + "/brightness").c_str(), O_RDWR | O_CLOEXEC);
+        powerFd = ::open((best + "/bl_power").c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd < 0 || max <= 0) {
+            std::cerr << "osm-powerd: cannot use backlight " << best << "\n";
+            if (fd >= 0) close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+    }
 
-        // Only grab the real ACPI "Power Button" device so logind can't power off.
-        if (isPowerName) {
-            grab = true;
+    void step(int percent) {
+        if (!open()) return;
+
+        char buf[32] = {0};
+        ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0) return;
+        long cur = strtol(buf, nullptr, 10);
+
+        long delta = max * percent / 100;
+        if (delta == 0) delta = percent > 0 ? 1 : -1;
+        long next = cur + delta;
+        // never all the way to black from a key; bl_power is for that
+        if (next < 1) next = 1;
+        if (next > max) next = max;
+
+        int len = snprintf(buf, sizeof(buf), "%ld", next);
+        if (pwrite(fd, buf, len, 0) < 0)
+            perror("osm-powerd: backlight");
+    }
+
+    void setPowered(bool on) {
+        if (!open() || powerFd < 0) return;
+        // FB_BLANK_UNBLANK / FB_BLANK_POWERDOWN; the level is untouched
+        const char *v = on ? "0" : "4";
+        if (pwrite(powerFd, v, 1, 0) < 0)
+            perror("osm-powerd: bl_power");
+    }
+};
+
+// ---------------------------------------------------------------------------
+
+struct PendingNode {
+    std::string path;
+    int tries;
+};
+
+struct Daemon {
+    int epfd = -1;
+    int ueventFd = -1;
+    int sigFd = -1;
+    std::vector<MonitoredDevice> devices;
+    std::vector<PendingNode> pending;   // hotplugged nodes not openable yet
+    Backlight backlight;
+    uid_t userUid = 0;            // session user, looked up on first use
+
+    // 0 if there is no session user; volume and the menu never run as root
+    uid_t sessionUid() {
+        if (!userUid) {
+            passwd *pw = getTargetUserPw();
+            if (pw) userUid = pw->pw_uid;
         }
+        return userUid;
+    }
 
-        if (!monitor) {
+    MonitoredDevice *findByFd(int fd) {
+        for (auto &d : devices)
+            if (d.fd == fd) return &d;
+        return nullptr;
+    }
+
+    bool isOpen(const std::string &path) const {
+        for (const auto &d : devices)
+            if (d.path == path) return true;
+        return false;
+    }
+
+    // Returns false only if the node can't be opened (yet).
+    bool openDevice(const std::string &path) {
+        if (isOpen(path)) return true;
+
+        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        std::string name = getDeviceName(fd);
+        bool isPowerName = (name.find("Power Button") != std::string::npos);
+
+        // Any device that can send a bound code is interesting,
+        // BUT only the grabbed one may trigger osm-power.
+        if (!deviceHasBoundCode(fd) && !isPowerName) {
             close(fd);
-            continue;
+            return true;
         }
 
-        if (grab) {
+        // timestamps on the clock latency and traces are measured with
+        int clk = CLOCK_BOOTTIME;
+        ioctl(fd, EVIOCSCLOCKID, &clk);
+
+        // Only grab the real ACPI "Power Button" device so logind can't power off.
+        bool grab = false;
+        if (isPowerName) {
             if (ioctl(fd, EVIOCGRAB, 1) < 0) {
                 perror("EVIOCGRAB failed");
             } else {
+                grab = true;
                 std::cout << "Exclusively grabbing: " << path
                           << " (" << name << ")\n";
             }
-        } else {
+        }
+        if (!grab) {
             std::cout << "Listening (no grab): " << path
                       << " (" << name << ")\n";
         }
 
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl");
+            close(fd);
+            return true;
+        }
+
         devices.push_back({fd, path, name, grab});
+        return true;
     }
 
-    if (devices.empty()) {
-        std::cerr << "No POWER BUTTON devices detected.\n";
-        return 1;
+    void closeDevice(int fd) {
+        for (auto it = devices.begin(); it != devices.end(); ++it) {
+            if (it->fd != fd) continue;
+            std::cout << "Removed: " << it->path << " (" << it->name << ")\n";
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            devices.erase(it);
+            return;
+        }
     }
 
+    void scanDevices() {
+        DIR *dir = opendir("/dev/input");
+        if (!dir) return;
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            if (strncmp(ent->d_name, "event", 5) != 0) continue;
+            openDevice(std::string("/dev/input/") + ent->d_name);
+        }
+        closedir(dir);
+    }
+
+    // Kernel uevents: "add@/devices/..." followed by NUL-separated
+    // KEY=value pairs. Only input event nodes coming and going matter.
+    void readUevents() {
+        char buf[8192];
+        ssize_t n;
+        while ((n = recv(ueventFd, buf, sizeof(buf) - 1, 0)) > 0) {
+            buf[n] = '\0';
+
+            const char *action = nullptr;
+            const char *subsystem = nullptr;
+            const char *devname = nullptr;
+            for (char *p = buf; p < buf + n; p += strlen(p) + 1) {
+                if (!strncmp(p, "ACTION=", 7))          action = p + 7;
+                else if (!strncmp(p, "SUBSYSTEM=", 10)) subsystem = p + 10;
+                else if (!strncmp(p, "DEVNAME=", 8))    devname = p + 8;
+            }
+            if (!action || !subsystem || !devname) continue;
+            if (strcmp(subsystem, "input") != 0) continue;
+            if (strncmp(devname, "input/event", 11) != 0) continue;
+
+            std::string path = std::string("/dev/") + devname;
+            if (!strcmp(action, "add")) {
+                if (!openDevice(path))
+                    pending.push_back({path, 0});
+            } else if (!strcmp(action, "remove")) {
+                for (auto it = pending.begin(); it != pending.end(); ++it) {
+                    if (it->path == path) {
+                        pending.erase(it);
+                        break;
+                    }
+                }
+                for (const auto &d : devices) {
+                    if (d.path == path) {
+                        closeDevice(d.fd);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // the node can show up a moment after its uevent; give it ~2 s
+    void retryPending() {
+        std::vector<PendingNode> still;
+        for (auto &p : pending)
+            if (!openDevice(p.path) && ++p.tries < 20)
+                still.push_back(p);
+        pending.swap(still);
+    }
+
+    void reapChildren() {
+        struct signalfd_siginfo si;
+        while (read(sigFd, &si, sizeof(si)) == sizeof(si)) {}
+        while (waitpid(-1, nullptr, WNOHANG) > 0) {}
+    }
+
+    void dispatch(const MonitoredDevice &src, const struct input_event &ev) {
+        if (ev.type != EV_KEY && ev.type != EV_SW) return;
+        if (ev.value < 0 || ev.value > 2) return;
+        unsigned mask = 1u << ev.value;
+
+        for (const Binding &b : BINDINGS) {
+            if (b.type != ev.type || b.code != ev.code || !(b.values & mask))
+                continue;
+
+            // ⚠ e.g. Intel Virtual Buttons also report KEY_POWER
+            if (b.grabbedOnly && !src.grabbed) {
+                std::cout << b.label << " from " << src.path << " (" << src.name
+                          << ") [no grab], ignored" << std::endl;
+                continue;
+            }
+
+            // span from the kernel's event timestamp to the action being done
+            uint64_t evNs = uint64_t(ev.input_event_sec) * 1000000000ull +
+                            uint64_t(ev.input_event_usec) * 1000ull;
+            trace(b.label, 'B', src.name.c_str(), evNs);
+            run(b.action);
+            trace(b.label, 'E');
+
+            struct timespec now;
+            clock_gettime(CLOCK_BOOTTIME, &now);
+            double ms = (now.tv_sec - ev.input_event_sec) * 1000.0 +
+                        (now.tv_nsec / 1000 - long(ev.input_event_usec)) / 1000.0;
+            std::cout << b.label << " from " << src.path << " (" << src.name << ")"
+                      << (src.grabbed ? " [grabbed]" : "")
+                      << " in " << ms << " ms" << std::endl;
+        }
+    }
+
+    void run(Action a) {
+        switch (a) {
+        case Action::PowerMenu:
+            // resident menu: one socket write, no fork/setuid/Qt start
+            if (sessionUid() && show_resident_osm_power(sessionUid())) {
+                trace("show-sent");
+                break;
+            }
+            // not running (yet): cold-start a one-shot menu as before
+            trace("osm-power-fork");
+            if (fork() == 0)
+                run_osm_power_as_user();
+            break;
+        case Action::VolumeUp:
+        case Action::VolumeDown:
+        case Action::VolumeMute:
+            if (sessionUid() && fork() == 0)
+                run_volume_as_user(sessionUid(), a);
+            break;
+        case Action::BrightnessUp:   backlight.step(BRIGHTNESS_STEP);   break;
+        case Action::BrightnessDown: backlight.step(-BRIGHTNESS_STEP);  break;
+        case Action::LidClosed:      backlight.setPowered(false);       break;
+        case Action::LidOpened:      backlight.setPowered(true);        break;
+        }
+    }
+};
+
+int main() {
+    Daemon d;
+
+    traceOpen("osm-powerd");
+
     // Setup epoll
-    int epfd = epoll_create1(0);
-    if (epfd < 0) {
+    d.epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (d.epfd < 0) {
         perror("epoll_create1");
         return 1;
     }
 
-    for (const auto &dev : devices) {
+    // SIGCHLD through a signalfd so forked osm-power instances get reaped
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, nullptr);
+    d.sigFd = signalfd(-1, &chld, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (d.sigFd < 0)
+        perror("signalfd");
+
+    // input hotplug straight from the kernel, no libudev needed
+    d.ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        NETLINK_KOBJECT_UEVENT);
+    if (d.ueventFd >= 0) {
+        struct sockaddr_nl addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1;   // kernel events
+        if (bind(d.ueventFd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror("bind uevent");
+            close(d.ueventFd);
+            d.ueventFd = -1;
+        }
+    } else {
+        perror("uevent socket");
+    }
+
+    for (int fd : {d.sigFd, d.ueventFd}) {
+        if (fd < 0) continue;
         struct epoll_event ev;
         ev.events = EPOLLIN;
-        ev.data.fd = dev.fd;
-        if (epoll_ctl(epfd, EPOLL_CTL_ADD, dev.fd, &ev) < 0) {
+        ev.data.fd = fd;
+        if (epoll_ctl(d.epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
             perror("epoll_ctl");
-        }
     }
 
+    // subscribed first, so nothing plugged in during the scan is missed
+    d.scanDevices();
+
+    if (d.devices.empty())
+        std::cerr << "No input devices with bound keys yet; waiting for hotplug.\n";
+
     struct epoll_event events[MAX_EVENTS];
 
     while (true) {
-        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        // while a hotplugged node is pending, wake every 100 ms to retry it
+        int n = epoll_wait(d.epfd, events, MAX_EVENTS, d.pending.empty() ? -1 : 100);
         if (n < 0)
             continue;
 
+        if (!d.pending.empty())
+            d.retryPending();
+
         for (int i = 0; i < n; i++) {
             int fd = events[i].data.fd;
-            struct input_event ev;
 
-            while (read(fd, &ev, sizeof(ev)) > 0) {
-                if (ev.type == EV_KEY &&
-                    ev.code == KEY_POWER &&
-                    ev.value != 0) {  // press or repeat
-
-                    // Find which device this fd belongs to
-                    const MonitoredDevice *src = nullptr;
-                    for (const auto &d : devices) {
-                        if (d.fd == fd) {
-                            src = &d;
-                            break;
-                        }
-                    }
+            if (fd == d.sigFd) {
+                d.reapChildren();
+                continue;
+            }
+            if (fd == d.ueventFd) {
+                d.readUevents();
+                continue;
+            }
 
-                    if (src) {
-                        std::cout << "POWER BUTTON PRESSED from "
-                                  << src->path << " (" << src->name << ")"
-                                  << (src->grabbed ? " [grabbed]" : " [no grab]")
-                                  << std::endl;
-                    } else {
-                        std::cout << "POWER BUTTON PRESSED from unknown fd "
-                                  << fd << std::endl;
-                    }
+            // closed by a remove uevent earlier in this batch
+            MonitoredDevice *src = d.findByFd(fd);
+            if (!src)
+                continue;
 
-                    // ⚠ Only trigger osm-power if this event came from the
-                    // grabbed real "Power Button" device. This prevents Intel
-                    // Virtual Buttons / F10 from acting as a power key.
-                    if (src && src->grabbed) {
-                        if (fork() == 0) {
-                            run_osm_power_as_user();
-                        }
-                    }
-                }
-            }
+            struct input_event ev;
+            ssize_t r;
+            while ((r = read(fd, &ev, sizeof(ev))) == sizeof(ev))
+                d.dispatch(*src, ev);
+
+            // unplugged without (or before) its remove uevent
+            if ((r < 0 && errno == ENODEV) || (events[i].events & (EPOLLHUP | EPOLLERR)))
+                d.closeDevice(fd);
         }
     }
 
@@ -0,0 +1,710 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/ipc.h>
+#include <sys/resource.h>
+#include <sys/shm.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+
+// osm-record: screen recorder for bug reports, started and stopped from
+// osm-rocker.
+//
+// Only what changed is read back. The root window carries an XDamage
+// object; on each frame tick the accumulated damage is subtracted into an
+// XFixes region, its rectangles are merged into full-width row bands and
+// each band is read with XShmGetImage straight into place in the current
+// frame (full width keeps the server's stride equal to ours). A static
+// screen raises no damage: no reads, no frames, no encoding.
+//
+// Changed frames go through a single-producer / single-consumer ring of
+// preallocated slots (atomics only; an eventfd is the doorbell), and only
+// the rows that changed since a slot was last used are copied into it. If
+// the encoder falls behind the ring is full and the frame is held back:
+// every tick retries it until a slot frees up, and newer damage simply
+// lands in the same held frame, so the video never ends up stale.
+// The encoder thread pipes raw BGRx to a local ffmpeg, which stamps each
+// frame as it arrives (-use_wallclock_as_timestamps) and writes variable
+// frame rate H.264, so an idle screen needs no filler frames.
+//
+// Once a second the frame rates, drops, share of the screen read and the
+// CPU of osm-record (getrusage) and ffmpeg (/proc/<pid>/stat) are printed
+// and written to $XDG_RUNTIME_DIR/osm-record.status.
+//
+//   osm-record [--fps N] [--out FILE]    record until SIGINT / SIGTERM
+//   osm-record --stop                    stop the running recorder and
+//                                        wait for the file to be finished
+
+static const int DEFAULT_FPS = 30;
+static const int MAX_FPS = 60;
+static const unsigned RING_SLOTS = 4;          // power of two
+static const int BAND_MERGE_ROWS = 16;         // join bands closer than this
+static const int REPORT_MS = 1000;
+static const int STOP_WAIT_MS = 10000;
+
+static std::string runtimeDir() {
+    const char *rt = std::getenv("XDG_RUNTIME_DIR");
+    if (rt && rt[0]) return rt;
+    return "/run/user/" + std::to_string(getuid());
+}
+
+static std::string pidPath()    { return runtimeDir() + "/osm-record.pid"; }
+static std::string statusPath() { return runtimeDir() + "/osm-record.status"; }
+
+static long long monoMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static double cpuSeconds(const rusage &ru) {
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+// utime + stime of another process, in seconds; -1 if it is gone
+static double procCpuSeconds(pid_t pid) {
+    std::ifstream f("/proc/" + std::to_string(pid) + "/stat");
+    std::string s;
+    if (!std::getline(f, s)) return -1;
+
+    // comm may contain spaces; fields resume after the last ')'
+    size_t paren = s.rfind(')');
+    if (paren == std::string::npos) return -1;
+    std::istringstream in(s.substr(paren + 2));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && in >> field; i++) {
+        if (i == 14) utime = std::stoull(field);
+        if (i == 15) stime = std::stoull(field);
+    }
+    return double(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static bool writeAll(int fd, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= w;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lock-free single-producer / single-consumer ring of frame slots. The
+// capture thread claims and publishes, the encoder thread takes and
+// releases; head and tail are the only shared state. The eventfd only
+// wakes the encoder when the ring was empty.
+
+class FrameRing {
+public:
+    bool init(size_t frameBytes) {
+        m_bell = eventfd(0, EFD_CLOEXEC);
+        if (m_bell < 0) return false;
+        for (Slot &s : m_slots) {
+            s.data = static_cast<uint8_t*>(malloc(frameBytes));
+            if (!s.data) return false;
+            s.gen = 0;
+        }
+        return true;
+    }
+
+    ~FrameRing() {
+        for (Slot &s : m_slots) free(s.data);
+        if (m_bell >= 0) close(m_bell);
+    }
+
+    // producer: a free slot, or nullptr when the encoder is behind
+    uint8_t *claim(uint64_t &gen) {
+        uint32_t h = m_head.load(std::memory_order_relaxed);
+        if (h - m_tail.load(std::memory_order_acquire) == RING_SLOTS)
+            return nullptr;
+        Slot &s = m_slots[h % RING_SLOTS];
+        gen = s.gen;
+        return s.data;
+    }
+
+    void publish(uint64_t gen) {
+        uint32_t h = m_head.load(std::memory_order_relaxed);
+        m_slots[h % RING_SLOTS].gen = gen;
+        m_head.store(h + 1, std::memory_order_release);
+        ring();
+    }
+
+    // consumer: blocks until a frame is ready; nullptr once closed and drained
+    const uint8_t *take() {
+        while (true) {
+            uint32_t t = m_tail.load(std::memory_order_relaxed);
+            if (m_head.load(std::memory_order_acquire) != t)
+                return m_slots[t % RING_SLOTS].data;
+            if (m_closed.load(std::memory_order_acquire))
+                return nullptr;
+            uint64_t v;
+            if (read(m_bell, &v, sizeof(v)) < 0 && errno != EINTR)
+                return nullptr;
+        }
+    }
+
+    void release() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    }
+
+    void shutdown() {
+        m_closed.store(true, std::memory_order_release);
+        ring();
+    }
+
+private:
+    struct Slot {
+        uint8_t *data = nullptr;
+        uint64_t gen = 0;       // capture generation the slot was filled at
+    };
+
+    void ring() {
+        uint64_t one = 1;
+        if (write(m_bell, &one, sizeof(one)) < 0) {}
+    }
+
+    Slot m_slots[RING_SLOTS];
+    int m_bell = -1;
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<bool> m_closed{false};
+};
+
+// ---------------------------------------------------------------------------
+
+struct Options {
+    int fps = DEFAULT_FPS;
+    std::string out;
+};
+
+class Recorder {
+public:
+    ~Recorder() {
+        if (m_image) {
+            XShmDetach(m_dpy, &m_shm);
+            shmdt(m_shm.shmaddr);
+            m_image->data = nullptr;
+            XDestroyImage(m_image);
+        }
+        if (m_region) XFixesDestroyRegion(m_dpy, m_region);
+        if (m_damage) XDamageDestroy(m_dpy, m_damage);
+        if (m_dpy) XCloseDisplay(m_dpy);
+    }
+
+    bool open() {
+        m_dpy = XOpenDisplay(nullptr);
+        if (!m_dpy) {
+            std::cerr << "osm-record: cannot open display\n";
+            return false;
+        }
+
+        int dErr, fEv, fErr;
+        if (!XDamageQueryExtension(m_dpy, &m_damageEvent, &dErr) ||
+            !XFixesQueryExtension(m_dpy, &fEv, &fErr)) {
+            std::cerr << "osm-record: needs the DAMAGE and XFIXES extensions\n";
+            return false;
+        }
+        if (!XShmQueryExtension(m_dpy)) {
+            std::cerr << "osm-record: needs MIT-SHM (a local display)\n";
+            return false;
+        }
+
+        m_root = DefaultRootWindow(m_dpy);
+        XWindowAttributes ra;
+        XGetWindowAttributes(m_dpy, m_root, &ra);
+        m_width = ra.width;
+        m_height = ra.height;
+
+        m_image = XShmCreateImage(m_dpy, ra.visual, ra.depth, ZPixmap, nullptr,
+                                  &m_shm, m_width, m_height);
+        if (!m_image || m_image->bits_per_pixel != 32) {
+            std::cerr << "osm-record: only 32 bpp screens are supported\n";
+            return false;
+        }
+        m_shm.shmid = shmget(IPC_PRIVATE, m_image->bytes_per_line * m_height,
+                             IPC_CREAT | 0600);
+        if (m_shm.shmid < 0) {
+            perror("osm-record: shmget");
+            return false;
+        }
+        m_shm.shmaddr = m_image->data = (char*)shmat(m_shm.shmid, nullptr, 0);
+        m_shm.readOnly = False;
+        bool ok = m_shm.shmaddr != (char*)-1 && XShmAttach(m_dpy, &m_shm);
+        XSync(m_dpy, False);
+        shmctl(m_shm.shmid, IPC_RMID, nullptr);
+        if (!ok) {
+            std::cerr << "osm-record: cannot attach the shared memory segment\n";
+            m_image->data = nullptr;
+            XDestroyImage(m_image);
+            m_image = nullptr;
+            return false;
+        }
+
+        m_stride = m_image->bytes_per_line;
+        m_rowGen.assign(m_height, 0);
+        if (!m_ring.init(size_t(m_stride) * m_height)) {
+            std::cerr << "osm-record: out of memory for the frame ring\n";
+            return false;
+        }
+
+        // NonEmpty: one event, then quiet until the next subtract
+        m_damage = XDamageCreate(m_dpy, m_root, XDamageReportNonEmpty);
+        m_region = XFixesCreateRegion(m_dpy, nullptr, 0);
+        XSelectInput(m_dpy, m_root, StructureNotifyMask);
+        XSync(m_dpy, False);
+        return true;
+    }
+
+    int run(const Options &opt) {
+        if (!startEncoder(opt.out))
+            return 1;
+        std::cout << "osm-record: " << m_width << "x" << m_height << " up to "
+                  << opt.fps << " fps -> " << opt.out << "\n" << std::flush;
+
+        sigset_t sigs;
+        sigemptyset(&sigs);
+        sigaddset(&sigs, SIGINT);
+        sigaddset(&sigs, SIGTERM);
+        sigaddset(&sigs, SIGCHLD);
+        int sigFd = signalfd(-1, &sigs, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        int tickFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        long tickNs = 1000000000L / opt.fps;
+        itimerspec its = {};
+        its.it_interval.tv_sec = tickNs / 1000000000L;
+        its.it_interval.tv_nsec = tickNs % 1000000000L;
+        its.it_value = its.it_interval;
+        if (tickFd < 0 || timerfd_settime(tickFd, 0, &its, nullptr) < 0) {
+            perror("osm-record: frame timer");
+            if (tickFd >= 0) close(tickFd);
+            close(sigFd);
+            finish();
+            return 1;
+        }
+
+        int reportFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        itimerspec rep = {};
+        rep.it_interval.tv_sec = REPORT_MS / 1000;
+        rep.it_value = rep.it_interval;
+        timerfd_settime(reportFd, 0, &rep, nullptr);
+
+        int ep = epoll_create1(EPOLL_CLOEXEC);
+        for (int fd : { ConnectionNumber(m_dpy), sigFd, tickFd, reportFd }) {
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+        }
+
+        // first frame is the whole screen
+        grabRows(0, m_height);
+        m_gen++;
+        std::fill(m_rowGen.begin(), m_rowGen.end(), m_gen);
+        publish();
+        m_lastReport = monoMs();
+        getrusage(RUSAGE_SELF, &m_lastUsage);
+        m_lastFfmpegCpu = procCpuSeconds(m_ffmpeg);
+
+        bool running = true;
+        while (running) {
+            epoll_event evs[4];
+            int n = epoll_wait(ep, evs, 4, XPending(m_dpy) ? 0 : -1);
+            if (n < 0 && errno != EINTR) {
+                perror("osm-record: epoll_wait");
+                break;
+            }
+
+            for (int i = 0; i < n; i++) {
+                int fd = evs[i].data.fd;
+                uint64_t expirations;
+                if (fd == sigFd) {
+                    signalfd_siginfo si;
+                    while (read(sigFd, &si, sizeof(si)) == sizeof(si)) {
+                        if (si.ssi_signo == SIGCHLD && si.ssi_pid != uint32_t(m_ffmpeg))
+                            continue;
+                        if (si.ssi_signo == SIGCHLD)
+                            std::cerr << "osm-record: ffmpeg exited early\n";
+                        running = false;
+                    }
+                } else if (fd == tickFd) {
+                    if (read(tickFd, &expirations, sizeof(expirations)) > 0)
+                        tick();
+                } else if (fd == reportFd) {
+                    if (read(reportFd, &expirations, sizeof(expirations)) > 0)
+                        report(false);
+                }
+            }
+
+            while (running && XPending(m_dpy)) {
+                XEvent ev;
+                XNextEvent(m_dpy, &ev);
+                if (ev.type == m_damageEvent + XDamageNotify) {
+                    m_damaged = true;
+                } else if (ev.type == ConfigureNotify && ev.xconfigure.window == m_root &&
+                           (ev.xconfigure.width != m_width ||
+                            ev.xconfigure.height != m_height)) {
+                    // rawvideo has a fixed size; end the file cleanly
+                    std::cerr << "osm-record: screen size changed, stopping\n";
+                    running = false;
+                }
+            }
+            if (m_encoderFailed.load()) {
+                std::cerr << "osm-record: writing to ffmpeg failed\n";
+                running = false;
+            }
+        }
+
+        close(ep);
+        close(tickFd);
+        close(reportFd);
+        close(sigFd);
+        return finish() ? 0 : 1;
+    }
+
+private:
+    bool startEncoder(const std::string &out) {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) < 0) {
+            perror("osm-record: pipe");
+            return false;
+        }
+        // a big pipe lets a whole frame go in without waking ffmpeg per page
+        fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+
+        std::string stride = std::to_string(m_stride / 4);
+        std::vector<std::string> args = {
+            "ffmpeg", "-hide_banner", "-loglevel", "error", "-y",
+            "-f", "rawvideo", "-pix_fmt", "bgr0",
+            "-video_size", stride + "x" + std::to_string(m_height),
+            "-use_wallclock_as_timestamps", "1",
+            "-i", "pipe:0",
+            // drop row padding, and yuv420p needs even dimensions
+            "-vf", "crop=" + std::to_string(m_width & ~1) + ":" +
+                   std::to_string(m_height & ~1) + ":0:0",
+            "-c:v", "libx264", "-preset", "ultrafast", "-crf", "23",
+            "-pix_fmt", "yuv420p", "-fps_mode", "vfr",
+            out
+        };
+        std::vector<char*> argv;
+        for (std::string &a : args) argv.push_back(&a[0]);
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t fa;
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_adddup2(&fa, fds[0], 0);
+
+        // ffmpeg must not inherit the blocked signal mask used for signalfd
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t none;
+        sigemptyset(&none);
+        posix_spawnattr_setsigmask(&attr, &none);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+        int rc = posix_spawnp(&m_ffmpeg, "ffmpeg", &fa, &attr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&fa);
+        posix_spawnattr_destroy(&attr);
+        close(fds[0]);
+        if (rc != 0) {
+            std::cerr << "osm-record: cannot start ffmpeg: " << strerror(rc) << "\n";
+            close(fds[1]);
+            return false;
+        }
+        m_pipe = fds[1];
+
+        m_encoder = std::thread([this]() { encodeLoop(); });
+        return true;
+    }
+
+    void encodeLoop() {
+        size_t bytes = size_t(m_stride) * m_height;
+        while (const uint8_t *frame = m_ring.take()) {
+            bool ok = writeAll(m_pipe, frame, bytes);
+            m_ring.release();
+            if (!ok) {
+                m_encoderFailed.store(true);
+                break;
+            }
+            m_encoded.fetch_add(1, std::memory_order_relaxed);
+        }
+        close(m_pipe);      // EOF: ffmpeg finishes the file
+    }
+
+    void tick() {
+        if (!m_damaged) {
+            // a dropped frame still has to go out once the screen is still
+            if (m_unpublished) publish();
+            return;
+        }
+        m_damaged = false;
+
+        XDamageSubtract(m_dpy, m_damage, None, m_region);
+        int n = 0;
+        XRectangle *rects = XFixesFetchRegion(m_dpy, m_region, &n);
+        if (!rects) return;
+
+        // rows touched, merged into bands
+        std::vector<std::pair<int, int>> rows;
+        for (int i = 0; i < n; i++) {
+            int y0 = std::max(0, int(rects[i].y));
+            int y1 = std::min(m_height, int(rects[i].y) + int(rects[i].height));
+            if (y1 > y0) rows.push_back({ y0, y1 });
+        }
+        XFree(rects);
+        if (rows.empty()) return;
+
+        std::sort(rows.begin(), rows.end());
+        std::vector<std::pair<int, int>> bands;
+        for (const auto &r : rows) {
+            if (!bands.empty() && r.first <= bands.back().second + BAND_MERGE_ROWS)
+                bands.back().second = std::max(bands.back().second, r.second);
+            else
+                bands.push_back(r);
+        }
+
+        m_gen++;
+        for (const auto &b : bands) {
+            grabRows(b.first, b.second);
+            std::fill(m_rowGen.begin() + b.first, m_rowGen.begin() + b.second, m_gen);
+        }
+        publish();
+    }
+
+    // Full-width band straight into the frame: a header describing just
+    // those rows, pointing into the same segment
+    void grabRows(int y0, int y1) {
+        XImage band = *m_image;
+        band.height = y1 - y0;
+        band.data = m_image->data + size_t(y0) * m_stride;
+        XShmGetImage(m_dpy, m_root, &band, 0, y0, AllPlanes);
+        m_rowsRead += y1 - y0;
+    }
+
+    // Copy rows changed since this slot last held a frame. A full ring
+    // leaves the frame unpublished; the next tick retries it.
+    bool publish() {
+        uint64_t slotGen;
+        uint8_t *slot = m_ring.claim(slotGen);
+        if (!slot) {
+            if (!m_unpublished) m_dropped++;
+            m_unpublished = true;
+            return false;
+        }
+
+        const uint8_t *src = reinterpret_cast<const uint8_t*>(m_image->data);
+        int y = 0;
+        while (y < m_height) {
+            if (m_rowGen[y] <= slotGen) { y++; continue; }
+            int end = y;
+            while (end < m_height && m_rowGen[end] > slotGen) end++;
+            memcpy(slot + size_t(y) * m_stride, src + size_t(y) * m_stride,
+                   size_t(end - y) * m_stride);
+            y = end;
+        }
+        m_ring.publish(m_gen);
+        m_captured++;
+        m_unpublished = false;
+        return true;
+    }
+
+    void report(bool final) {
+        long long now = monoMs();
+        double wall = (now - m_lastReport) / 1000.0;
+        if (wall <= 0) return;
+
+        rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        double self = (cpuSeconds(ru) - cpuSeconds(m_lastUsage)) / wall * 100;
+        double ff = procCpuSeconds(m_ffmpeg);
+        double ffPct = (ff >= 0 && m_lastFfmpegCpu >= 0) ? (ff - m_lastFfmpegCpu) / wall * 100 : 0;
+
+        uint64_t encoded = m_encoded.load(std::memory_order_relaxed);
+        double readPct = m_captured ? 100.0 * m_rowsRead / (double(m_captured) * m_height) : 0;
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "osm-record: %s%.0f fps captured, %.0f encoded, %llu dropped, "
+                 "%.0f%% of screen read per frame, cpu %.1f%% + ffmpeg %.1f%%",
+                 final ? "done: " : "",
+                 m_captured / wall, (encoded - m_lastEncoded) / wall,
+                 (unsigned long long)m_dropped, readPct, self, ffPct);
+        std::cout << line << "\n" << std::flush;
+
+        std::ofstream status(statusPath(), std::ios::trunc);
+        status << line << "\n";
+
+        m_lastReport = now;
+        m_lastUsage = ru;
+        m_lastFfmpegCpu = ff;
+        m_lastEncoded = encoded;
+        m_captured = 0;
+        m_rowsRead = 0;
+    }
+
+    bool finish() {
+        // the last captured state must reach the file; wait for the
+        // encoder to free a slot
+        long long giveUp = monoMs() + STOP_WAIT_MS;
+        while (m_unpublished && !publish() && !m_encoderFailed.load() &&
+               monoMs() < giveUp)
+            usleep(5000);
+
+        m_ring.shutdown();
+        if (m_encoder.joinable()) m_encoder.join();
+
+        int status = 0;
+        while (waitpid(m_ffmpeg, &status, 0) < 0 && errno == EINTR) {}
+        report(true);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    Display *m_dpy = nullptr;
+    Window m_root = 0;
+    int m_width = 0, m_height = 0, m_stride = 0;
+    int m_damageEvent = 0;
+    Damage m_damage = 0;
+    XserverRegion m_region = 0;
+    XImage *m_image = nullptr;
+    XShmSegmentInfo m_shm;
+    bool m_damaged = false;
+    bool m_unpublished = false;     // captured, but the ring was full
+
+    uint64_t m_gen = 0;
+    std::vector<uint64_t> m_rowGen;     // generation each row last changed at
+    FrameRing m_ring;
+    std::thread m_encoder;
+    pid_t m_ffmpeg = -1;
+    int m_pipe = -1;
+    std::atomic<bool> m_encoderFailed{false};
+    std::atomic<uint64_t> m_encoded{0};
+
+    long long m_lastReport = 0;
+    rusage m_lastUsage = {};
+    double m_lastFfmpegCpu = -1;
+    uint64_t m_lastEncoded = 0;
+    uint64_t m_captured = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_rowsRead = 0;
+};
+
+// ---------------------------------------------------------------------------
+
+// Signal the running recorder and wait until it has released its lock,
+// which it holds until ffmpeg has finished the file
+static int stopRecorder() {
+    int fd = open(pidPath().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || flock(fd, LOCK_SH | LOCK_NB) == 0) {
+        std::cerr << "osm-record: not recording\n";
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+
+    char buf[32] = {0};
+    pid_t pid = 0;
+    if (pread(fd, buf, sizeof(buf) - 1, 0) > 0)
+        pid = atoi(buf);
+    if (pid <= 0 || kill(pid, SIGINT) < 0) {
+        perror("osm-record: stop");
+        close(fd);
+        return 1;
+    }
+
+    long long until = monoMs() + STOP_WAIT_MS;
+    while (monoMs() < until) {
+        if (flock(fd, LOCK_SH | LOCK_NB) == 0) {
+            close(fd);
+            return 0;
+        }
+        usleep(50 * 1000);
+    }
+    std::cerr << "osm-record: recorder did not stop in time\n";
+    close(fd);
+    return 1;
+}
+
+static std::string defaultOutput() {
+    const char *home = std::getenv("HOME");
+    std::string dir = std::string(home ? home : "/tmp") + "/Videos";
+    mkdir(dir.c_str(), 0755);
+
+    char stamp[32];
+    time_t t = time(nullptr);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&t));
+    return dir + "/recording-" + stamp + ".mp4";
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--stop") return stopRecorder();
+        if (a == "--fps" && i + 1 < argc)      opt.fps = atoi(argv[++i]);
+        else if (a == "--out" && i + 1 < argc) opt.out = argv[++i];
+        else {
+            std::cerr << "usage: osm-record [--fps N] [--out FILE] | --stop\n";
+            return 2;
+        }
+    }
+    opt.fps = std::max(1, std::min(opt.fps, MAX_FPS));
+    if (opt.out.empty()) opt.out = defaultOutput();
+
+    // one recorder at a time; the lock is held for the whole run
+    int pidFd = open(pidPath().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (pidFd < 0 || flock(pidFd, LOCK_EX | LOCK_NB) < 0) {
+        std::cerr << "osm-record: already recording\n";
+        return 1;
+    }
+    std::string pid = std::to_string(getpid()) + "\n";
+    if (ftruncate(pidFd, 0) < 0 || pwrite(pidFd, pid.c_str(), pid.size(), 0) < 0) {}
+
+    // block before any thread starts so every thread inherits the mask
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGINT);
+    sigaddset(&sigs, SIGTERM);
+    sigaddset(&sigs, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigs, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    int rc = 1;
+    {
+        Recorder r;
+        if (r.open())
+            rc = r.run(opt);
+    }
+
+    unlink(pidPath().c_str());
+    close(pidFd);
+    return rc;
+}
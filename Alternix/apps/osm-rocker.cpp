@@ -16,8 +16,588 @@
 #include <QVector>
 #include <QDebug>
 #include <QTimer>
-#include <QThread>
 #include <QGraphicsDropShadowEffect>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QCloseEvent>
+#include <QImage>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <QEvent>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "common/fdnotifier.h"
+
+// ───────────────────────────────────────────────
+// Toast shown at the top of the screen after an action
+static QWidget* buildToast(const QString &message, bool ok = true) {
+    QWidget *toast = new QWidget(nullptr);
+    toast->setWindowFlags(Qt::FramelessWindowHint |
+                          Qt::WindowStaysOnTopHint |
+                          Qt::Tool);
+
+    toast->setAttribute(Qt::WA_TranslucentBackground);
+
+    QRect g = QGuiApplication::primaryScreen()->geometry();
+    toast->setGeometry(g.x(), g.y()+10, g.width(), 50);
+
+    QWidget *box = new QWidget(toast);
+    box->setGeometry(20, 0, g.width()-40, 50);
+    box->setStyleSheet(
+        "background-color: #282828;"
+        "border-radius: 10px;"
+    );
+
+    auto *layout = new QHBoxLayout(box);
+    layout->setContentsMargins(15, 5, 15, 5);
+
+    QLabel *tick = new QLabel(ok ? "✔" : "✖", box);
+    tick->setStyleSheet(ok ? "color:#00FF66; font-size:22px; font-weight:bold;"
+                           : "color:#FF4444; font-size:22px; font-weight:bold;");
+
+    QLabel *msg = new QLabel(message, box);
+    msg->setStyleSheet("color:white; font-size:20px;");
+
+    layout->addWidget(tick);
+    layout->addSpacing(10);
+    layout->addWidget(msg);
+
+    return toast;
+}
+
+// ───────────────────────────────────────────────
+// Screenshot encoding. Runs on a worker thread, so it only touches the
+// QImage it was handed and the file.
+
+// QOI (qoiformat.org): lossless, one pass with a 64-entry colour cache;
+// several times faster than zlib on a screen-sized frame.
+static QByteArray encodeQoi(const QImage &src) {
+    QImage img = src.format() == QImage::Format_RGB32
+        ? src : src.convertToFormat(QImage::Format_RGB32);
+    const int w = img.width(), h = img.height();
+
+    QByteArray out;
+    out.resize(14 + w * h * 4 + 8);     // worst case: every pixel QOI_OP_RGB
+    uchar *p = reinterpret_cast<uchar*>(out.data());
+
+    auto be32 = [&p](quint32 v) {
+        *p++ = v >> 24; *p++ = v >> 16; *p++ = v >> 8; *p++ = v;
+    };
+    memcpy(p, "qoif", 4); p += 4;
+    be32(w);
+    be32(h);
+    *p++ = 3;       // RGB
+    *p++ = 0;       // sRGB
+
+    QRgb index[64] = {0};
+    QRgb prev = 0xff000000;
+    int run = 0;
+
+    for (int y = 0; y < h; y++) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        for (int x = 0; x < w; x++) {
+            QRgb px = line[x] | 0xff000000;
+            if (px == prev) {
+                if (++run == 62) { *p++ = 0xc0 | (run - 1); run = 0; }
+                continue;
+            }
+            if (run) { *p++ = 0xc0 | (run - 1); run = 0; }
+
+            int r = qRed(px), g = qGreen(px), b = qBlue(px);
+            int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+            if (index[hash] == px) {
+                *p++ = hash;
+            } else {
+                index[hash] = px;
+                int dr = qint8(r - qRed(prev));
+                int dg = qint8(g - qGreen(prev));
+                int db = qint8(b - qBlue(prev));
+                int drg = dr - dg, dbg = db - dg;
+
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *p++ = 0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 &&
+                           dbg >= -8 && dbg <= 7) {
+                    *p++ = 0x80 | (dg + 32);
+                    *p++ = (drg + 8) << 4 | (dbg + 8);
+                } else {
+                    *p++ = 0xfe; *p++ = r; *p++ = g; *p++ = b;
+                }
+            }
+            prev = px;
+        }
+    }
+    if (run) *p++ = 0xc0 | (run - 1);
+    memcpy(p, "\0\0\0\0\0\0\0\1", 8); p += 8;
+
+    out.resize(p - reinterpret_cast<uchar*>(out.data()));
+    return out;
+}
+
+static bool writeShot(const QImage &img, const QString &path, const QByteArray &format,
+                      QString &error) {
+    if (format == "qoi") {
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly) || f.write(encodeQoi(img)) < 0 || !f.commit()) {
+            error = f.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    QImageWriter w(path, format);
+    // webp: 100 is lossless. png: Qt maps quality to a zlib level as
+    // (100 - q) * 9 / 91, so 80 is level 1 — about as small as the
+    // default level 6 on screen content, at a fraction of the time.
+    w.setQuality(format == "webp" ? 100 : 80);
+    if (!w.write(img)) {
+        error = w.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ~/.config/Alternix/osm-rocker.ini, [screenshot] format=png|webp|qoi
+static QByteArray shotFormat() {
+    QSettings s(QDir::homePath()+"/.config/Alternix/osm-rocker.ini",
+                QSettings::IniFormat);
+    QByteArray f = s.value("screenshot/format", "png").toString().toLower().toLatin1();
+    if (f == "qoi") return f;
+    if (f == "webp" && QImageWriter::supportedImageFormats().contains("webp")) return f;
+    if (f != "png")
+        qWarning() << "osm-rocker: screenshot format" << f << "not available, using png";
+    return "png";
+}
+
+// osm-record holds a lock on its pid file for as long as it records
+static bool recorderRunning() {
+    QByteArray dir = qgetenv("XDG_RUNTIME_DIR");
+    if (dir.isEmpty())
+        dir = "/run/user/" + QByteArray::number(getuid());
+    int fd = open((dir + "/osm-record.pid").constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool locked = flock(fd, LOCK_SH | LOCK_NB) < 0 && errno == EWOULDBLOCK;
+    close(fd);
+    return locked;
+}
+
+// ───────────────────────────────────────────────
+// Drag out a rectangle on the frozen frame; a tap or Escape cancels.
+class RegionPicker : public QWidget {
+public:
+    std::function<void(const QRect&)> onPicked;     // empty rect = cancelled
+
+    explicit RegionPicker(const QImage &frame)
+        : m_frame(QPixmap::fromImage(frame))
+    {
+        setWindowFlags(Qt::FramelessWindowHint
+                       | Qt::WindowStaysOnTopHint
+                       | Qt::BypassWindowManagerHint);
+        setAttribute(Qt::WA_DeleteOnClose);
+        setGeometry(QGuiApplication::primaryScreen()->geometry());
+        setCursor(Qt::CrossCursor);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter p(this);
+        p.drawPixmap(0, 0, m_frame);
+
+        QRegion dim(rect());
+        dim -= m_sel;
+        p.setClipRegion(dim);
+        p.fillRect(rect(), QColor(0, 0, 0, 110));
+        p.setClipping(false);
+
+        if (!m_sel.isEmpty()) {
+            p.setPen(QPen(Qt::white, 2));
+            p.drawRect(m_sel.adjusted(0, 0, -1, -1));
+        }
+    }
+
+    void mousePressEvent(QMouseEvent *e) override {
+        m_from = e->pos();
+        m_sel = QRect();
+        update();
+    }
+
+    void mouseMoveEvent(QMouseEvent *e) override {
+        m_sel = QRect(m_from, e->pos()).normalized();
+        update();
+    }
+
+    void mouseReleaseEvent(QMouseEvent *) override {
+        finish(m_sel.width() >= kMinSide && m_sel.height() >= kMinSide ? m_sel : QRect());
+    }
+
+    void keyPressEvent(QKeyEvent *e) override {
+        if (e->key() == Qt::Key_Escape)
+            finish(QRect());
+        else if (e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter)
+            finish(m_sel);
+    }
+
+private:
+    static const int kMinSide = 8;
+
+    void finish(const QRect &r) {
+        if (m_done) return;
+        m_done = true;
+        std::function<void(const QRect&)> cb = onPicked;
+        close();
+        if (cb) cb(r);
+    }
+
+    QPixmap m_frame;
+    QPoint m_from;
+    QRect m_sel;
+    bool m_done = false;
+};
+
+// ───────────────────────────────────────────────
+// One screenshot, from the menu tap to the toast.
+//
+// The overlay has to be off screen first. Instead of sleeping, the grabber
+// watches the overlay's UnmapNotify on its own X connection, then the
+// root's damage over the panel area, and grabs once the repaint under the
+// panel has been quiet for a frame (fallbacks cover a server without
+// XDamage or a repaint that never comes). The grab is one XShmGetImage
+// into a fresh segment that the QImage then owns, so nothing is copied;
+// encoding runs on a worker thread.
+
+enum class ShotMode { Full, Region, Window };
+
+// The grabber's connection asks about windows that may already be gone
+// (_NET_ACTIVE_WINDOW) and may be refused SHM; the default handler would
+// exit mid-screenshot. Errors are only counted, and checked where a
+// fallback exists.
+static int s_xErrors = 0;
+
+static int countXError(Display *, XErrorEvent *) {
+    s_xErrors++;
+    return 0;
+}
+
+class ScreenGrabber : public QObject {
+public:
+    static const int kSettleMs     = 20;     // damage-quiet time after unmap
+    static const int kRepaintWait  = 120;    // unmapped, nothing repainted
+    static const int kUnmapWait    = 400;    // UnmapNotify never came
+
+    static bool busy() { return s_live > 0; }
+
+    ScreenGrabber(ShotMode mode, WId overlay, const QRect &panelRect)
+        : m_mode(mode), m_overlay(Window(overlay)), m_panel(panelRect)
+    {
+        s_live++;
+
+        m_settle = new QTimer(this);
+        m_settle->setSingleShot(true);
+        connect(m_settle, &QTimer::timeout, this, [this]() { grab(); });
+
+        m_deadline = new QTimer(this);
+        m_deadline->setSingleShot(true);
+        connect(m_deadline, &QTimer::timeout, this, [this]() { grab(); });
+    }
+
+    ~ScreenGrabber() override {
+        closeDisplay();
+        // the overlay is gone by now; we were the last thing keeping the
+        // app alive
+        if (--s_live == 0)
+            QCoreApplication::quit();
+    }
+
+    // Call before the overlay closes
+    void start() {
+        m_clock.start();
+
+        m_dpy = XOpenDisplay(nullptr);
+        if (!m_dpy) {
+            m_deadline->start(kRepaintWait);
+            return;
+        }
+        XSetErrorHandler(countXError);
+
+        XSelectInput(m_dpy, m_overlay, StructureNotifyMask);
+
+        int dErr;
+        if (XDamageQueryExtension(m_dpy, &m_damageEvent, &dErr))
+            m_damage = XDamageCreate(m_dpy, DefaultRootWindow(m_dpy),
+                                     XDamageReportRawRectangles);
+        XSync(m_dpy, False);
+
+        m_notifier = new FdNotifier(ConnectionNumber(m_dpy), [this]() { readX(); }, this);
+        m_deadline->start(kUnmapWait);
+    }
+
+private:
+    void readX() {
+        while (m_dpy && XPending(m_dpy)) {
+            XEvent ev;
+            XNextEvent(m_dpy, &ev);
+
+            if ((ev.type == UnmapNotify && ev.xunmap.window == m_overlay) ||
+                (ev.type == DestroyNotify && ev.xdestroywindow.window == m_overlay)) {
+                if (m_offscreenMs >= 0) continue;
+                m_offscreenMs = m_clock.elapsed();
+                // the settle timer also keeps the grab (which closes this
+                // connection) out of the notifier callback
+                if (!m_damage)
+                    m_settle->start(0);
+                else
+                    m_deadline->start(kRepaintWait);
+            } else if (m_damage && ev.type == m_damageEvent + XDamageNotify &&
+                       m_offscreenMs >= 0) {
+                const XDamageNotifyEvent *de =
+                    reinterpret_cast<const XDamageNotifyEvent*>(&ev);
+                QRect area(de->area.x, de->area.y, de->area.width, de->area.height);
+                if (area.intersects(m_panel))
+                    m_settle->start(kSettleMs);
+            }
+        }
+    }
+
+    void grab() {
+        if (m_grabbed) return;
+        m_grabbed = true;
+        m_settle->stop();
+        m_deadline->stop();
+
+        if (m_offscreenMs < 0) m_offscreenMs = m_clock.elapsed();
+        qint64 t0 = m_clock.elapsed();
+        QImage frame = grabRoot();
+        m_grabMs = m_clock.elapsed() - t0;
+
+        QRect window;
+        if (m_mode == ShotMode::Window)
+            window = activeWindowRect();
+        closeDisplay();
+
+        if (frame.isNull()) {
+            finished(false, QString(), "could not read the screen", 0);
+            return;
+        }
+
+        if (m_mode == ShotMode::Region) {
+            pickRegion(frame);
+            return;
+        }
+        if (m_mode == ShotMode::Window) {
+            window &= frame.rect();
+            if (!window.isEmpty())
+                frame = frame.copy(window);
+        }
+        encode(frame);
+    }
+
+    // Root window contents as Format_RGB32. With MIT-SHM the segment is
+    // the image's buffer and is detached when the last copy goes away.
+    QImage grabRoot() {
+        if (!m_dpy) {
+            QScreen *scr = QGuiApplication::primaryScreen();
+            return scr ? scr->grabWindow(0).toImage() : QImage();
+        }
+
+        Window root = DefaultRootWindow(m_dpy);
+        XWindowAttributes ra;
+        if (!XGetWindowAttributes(m_dpy, root, &ra)) return QImage();
+        const int w = ra.width, h = ra.height;
+
+        if (XShmQueryExtension(m_dpy)) {
+            XShmSegmentInfo shm;
+            XImage *img = XShmCreateImage(m_dpy, ra.visual, ra.depth, ZPixmap,
+                                          nullptr, &shm, w, h);
+            if (img && rgb32(img)) {
+                shm.shmid = shmget(IPC_PRIVATE, img->bytes_per_line * img->height,
+                                   IPC_CREAT | 0600);
+                if (shm.shmid >= 0) {
+                    shm.shmaddr = img->data = (char*)shmat(shm.shmid, nullptr, 0);
+                    shm.readOnly = False;
+
+                    // a refused attach (BadAccess) only shows up as an error
+                    int errors = s_xErrors;
+                    bool attached = shm.shmaddr != (char*)-1 && XShmAttach(m_dpy, &shm);
+                    if (attached) {
+                        XSync(m_dpy, False);
+                        attached = s_xErrors == errors;
+                    }
+                    bool ok = attached && XShmGetImage(m_dpy, root, img, 0, 0, AllPlanes);
+                    // GetImage is a round trip, so the server is done with it
+                    if (attached) XShmDetach(m_dpy, &shm);
+                    XSync(m_dpy, False);
+                    shmctl(shm.shmid, IPC_RMID, nullptr);
+
+                    int bpl = img->bytes_per_line;
+                    img->data = nullptr;
+                    XDestroyImage(img);
+
+                    if (ok)
+                        return QImage(reinterpret_cast<uchar*>(shm.shmaddr), w, h, bpl,
+                                      QImage::Format_RGB32,
+                                      [](void *addr) { shmdt(addr); }, shm.shmaddr);
+                    if (shm.shmaddr != (char*)-1) shmdt(shm.shmaddr);
+                    img = nullptr;
+                }
+            }
+            if (img) XDestroyImage(img);
+        }
+
+        // no SHM (remote display): plain GetImage, one copy
+        XImage *img = XGetImage(m_dpy, root, 0, 0, w, h, AllPlanes, ZPixmap);
+        if (!img) return QImage();
+        QImage out;
+        if (rgb32(img))
+            out = QImage(reinterpret_cast<const uchar*>(img->data), w, h,
+                         img->bytes_per_line, QImage::Format_RGB32).copy();
+        XDestroyImage(img);
+        return out;
+    }
+
+    static bool rgb32(const XImage *img) {
+        return img->bits_per_pixel == 32 && img->byte_order == LSBFirst &&
+               img->red_mask == 0xff0000 && img->green_mask == 0x00ff00 &&
+               img->blue_mask == 0x0000ff;
+    }
+
+    // _NET_ACTIVE_WINDOW in root coordinates; the overlay never takes focus,
+    // so this is still the app underneath
+    QRect activeWindowRect() {
+        if (!m_dpy) return QRect();
+        Window root = DefaultRootWindow(m_dpy);
+        Atom netActive = XInternAtom(m_dpy, "_NET_ACTIVE_WINDOW", False);
+
+        Atom type;
+        int format;
+        unsigned long n, after;
+        unsigned char *data = nullptr;
+        Window active = 0;
+        if (XGetWindowProperty(m_dpy, root, netActive, 0, 1, False, XA_WINDOW,
+                               &type, &format, &n, &after, &data) == Success && data) {
+            if (n == 1) active = *reinterpret_cast<Window*>(data);
+            XFree(data);
+        }
+        if (!active) return QRect();
+
+        XWindowAttributes wa;
+        Window child;
+        int x, y;
+        if (!XGetWindowAttributes(m_dpy, active, &wa) ||
+            !XTranslateCoordinates(m_dpy, active, root, 0, 0, &x, &y, &child))
+            return QRect();
+        return QRect(x, y, wa.width, wa.height);
+    }
+
+    void pickRegion(const QImage &frame) {
+        RegionPicker *picker = new RegionPicker(frame);
+        QPoint origin = picker->geometry().topLeft();
+        qint64 shownAt = m_clock.elapsed();
+        picker->onPicked = [this, frame, origin, shownAt](const QRect &r) {
+            if (r.isEmpty()) {
+                deleteLater();
+                return;
+            }
+            m_pickingMs = m_clock.elapsed() - shownAt;
+            encode(frame.copy(r.translated(origin)));
+        };
+        picker->show();
+        picker->raise();
+        picker->activateWindow();
+    }
+
+    void encode(const QImage &img) {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+        if (dir.isEmpty()) dir = QDir::homePath();
+        QDir d(dir);
+        if (!d.exists()) d.mkpath(".");
+
+        QByteArray format = shotFormat();
+        QString path = d.filePath("screenshot-" +
+            QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + "." +
+            QString::fromLatin1(format));
+
+        std::thread([this, img, path, format]() {
+            QElapsedTimer t;
+            t.start();
+            QString error;
+            bool ok = writeShot(img, path, format, error);
+            qint64 ms = t.elapsed();
+            QMetaObject::invokeMethod(this, [this, ok, path, error, ms]() {
+                finished(ok, path, error, ms);
+            }, Qt::QueuedConnection);
+        }).detach();
+    }
+
+    void finished(bool ok, const QString &path, const QString &error, qint64 encodeMs) {
+        // neither counts the time spent dragging out a region
+        qint64 captureMs = m_grabMs + encodeMs;
+        qint64 total = m_clock.elapsed() - m_pickingMs;
+
+        QWidget *toast;
+        if (ok) {
+            qDebug().noquote() << QString("osm-rocker: %1 — off-screen %2 ms, grab %3 ms, "
+                                          "encode %4 ms, capture-to-file %5 ms, tap-to-file %6 ms")
+                .arg(path).arg(m_offscreenMs).arg(m_grabMs).arg(encodeMs)
+                .arg(captureMs).arg(total);
+            toast = buildToast(QString("Screenshot saved to ~/Pictures (%1 ms)").arg(captureMs));
+        } else {
+            qWarning() << "osm-rocker: screenshot failed:" << path << error;
+            toast = buildToast("Screenshot failed", false);
+        }
+        toast->show();
+        toast->raise();
+
+        QTimer::singleShot(2000, this, [this, toast](){
+            toast->close();
+            toast->deleteLater();
+            deleteLater();
+        });
+    }
+
+    void closeDisplay() {
+        if (!m_dpy) return;
+        delete m_notifier;
+        m_notifier = nullptr;
+        if (m_damage) XDamageDestroy(m_dpy, m_damage);
+        m_damage = 0;
+        XCloseDisplay(m_dpy);
+        m_dpy = nullptr;
+    }
+
+    static int s_live;
+
+    ShotMode m_mode;
+    Window m_overlay;
+    QRect m_panel;
+    Display *m_dpy = nullptr;
+    Damage m_damage = 0;
+    int m_damageEvent = 0;
+    FdNotifier *m_notifier = nullptr;
+    QTimer *m_settle;
+    QTimer *m_deadline;
+    bool m_grabbed = false;
+    QElapsedTimer m_clock;
+    qint64 m_offscreenMs = -1;
+    qint64 m_grabMs = 0;
+    qint64 m_pickingMs = 0;
+};
+
+int ScreenGrabber::s_live = 0;
 
 class OverlayPanel : public QWidget {
 public:
@@ -71,6 +651,9 @@ public:
             "🐁 Mouse scroll",
           //  "Keyboard scroll",
             "📸 Screenshot",
+            "🔲 Region screenshot",
+            "🪟 Window screenshot",
+            recorderRunning() ? "⏹ Stop recording" : "⏺ Record screen",
             "📛 Power Menu"
         };
 
@@ -98,6 +681,8 @@ public:
 
         currentIndex = 0;
         updateHighlight();
+
+        listenForRocker();
     }
 
     void gpioUp()      { moveSelection(-1); }
@@ -106,6 +691,13 @@ public:
 
 protected:
 
+    // gone from the socket as soon as it closes, so osm-gpiod goes back to
+    // volume / scroll for the rocker
+    void closeEvent(QCloseEvent *e) override {
+        rockerServer->close();
+        QWidget::closeEvent(e);
+    }
+
     // No blackout overlay — background stays visible
     void paintEvent(QPaintEvent *) override {}
 
@@ -213,6 +805,45 @@ private:
     QWidget *panel;
     QVector<QLabel*> menuLabels;
     int currentIndex;
+    QLocalServer *rockerServer;
+
+    // ───────────────────────────────────────────────
+    // osm-gpiod sends the hardware rocker here while the overlay is open:
+    // one "up", "down", "select" or "close" per line.
+    void listenForRocker() {
+        QByteArray dir = qgetenv("XDG_RUNTIME_DIR");
+        if (dir.isEmpty())
+            dir = "/run/user/" + QByteArray::number(getuid());
+        QString path = QString::fromLocal8Bit(dir + "/osm-rocker.sock");
+
+        rockerServer = new QLocalServer(this);
+        QLocalServer::removeServer(path);
+        if (!rockerServer->listen(path)) {
+            qWarning() << "osm-rocker: cannot listen on" << path << rockerServer->errorString();
+            return;
+        }
+
+        connect(rockerServer, &QLocalServer::newConnection, this, [this]() {
+            while (QLocalSocket *s = rockerServer->nextPendingConnection()) {
+                connect(s, &QLocalSocket::disconnected, s, &QObject::deleteLater);
+                connect(s, &QLocalSocket::readyRead, this, [this, s]() {
+                    while (s->canReadLine()) {
+                        QByteArray cmd = s->readLine().trimmed();
+                        // queued: select/close may delete the overlay (and
+                        // with it this socket)
+                        QTimer::singleShot(0, this, [this, cmd]() { rockerCommand(cmd); });
+                    }
+                });
+            }
+        });
+    }
+
+    void rockerCommand(const QByteArray &cmd) {
+        if (cmd == "up")          gpioUp();
+        else if (cmd == "down")   gpioDown();
+        else if (cmd == "select") gpioSelect();
+        else if (cmd == "close")  close();
+    }
 
     void moveSelection(int delta) {
         currentIndex += delta;
@@ -237,7 +868,11 @@ private:
         if (item == "🔊 Volume")                 { setGpioMode("volume"); close(); return; }
         if (item == "🐁 Mouse scroll")           { setGpioMode("scroll"); close(); return; }
         //if (item == "Keyboard scroll")           { setGpioMode("keys");   close(); return; }
-        if (item == "📸 Screenshot")             { doScreenshot();        return; }
+        if (item == "📸 Screenshot")             { doScreenshot(ShotMode::Full);   return; }
+        if (item == "🔲 Region screenshot")      { doScreenshot(ShotMode::Region); return; }
+        if (item == "🪟 Window screenshot")      { doScreenshot(ShotMode::Window); return; }
+        if (item == "⏺ Record screen")           { startRecording();      return; }
+        if (item == "⏹ Stop recording")          { stopRecording();       return; }
         if (item == "📛 Power Menu")             { openPowerMenu();       close(); return; }
     }
 
@@ -248,72 +883,44 @@ private:
         s.sync();
     }
 
-    QWidget* buildToast(const QString &message) {
-        QWidget *toast = new QWidget(nullptr);
-        toast->setWindowFlags(Qt::FramelessWindowHint |
-                              Qt::WindowStaysOnTopHint |
-                              Qt::Tool);
-
-        toast->setAttribute(Qt::WA_TranslucentBackground);
-
-        QRect g = QGuiApplication::primaryScreen()->geometry();
-        toast->setGeometry(g.x(), g.y()+10, g.width(), 50);
-
-        QWidget *box = new QWidget(toast);
-        box->setGeometry(20, 0, g.width()-40, 50);
-        box->setStyleSheet(
-            "background-color: #282828;"
-            "border-radius: 10px;"
-        );
-
-        auto *layout = new QHBoxLayout(box);
-        layout->setContentsMargins(15, 5, 15, 5);
-
-        QLabel *tick = new QLabel("✔", box);
-        tick->setStyleSheet("color:#00FF66; font-size:22px; font-weight:bold;");
-
-        QLabel *msg = new QLabel(message, box);
-        msg->setStyleSheet("color:white; font-size:20px;");
-
-        layout->addWidget(tick);
-        layout->addSpacing(10);
-        layout->addWidget(msg);
+    // The grabber outlives the overlay; it starts watching before close()
+    // so the unmap can't slip past it. The margin covers the panel shadow.
+    void doScreenshot(ShotMode mode) {
+        QRect panelRect = panel->geometry();
+        panelRect.moveTopLeft(panel->mapToGlobal(QPoint(0,0)));
 
-        return toast;
+        ScreenGrabber *g = new ScreenGrabber(mode, winId(), panelRect.adjusted(-40, -40, 40, 40));
+        g->start();
+        close();
     }
 
-    void doScreenshot() {
-        setWindowOpacity(0.0);
-        panel->hide();
-        QApplication::processEvents();
-        QThread::msleep(60);
-
-        QScreen *scr = QGuiApplication::primaryScreen();
-        if (!scr) { close(); return; }
-
-        QPixmap pix = scr->grabWindow(0);
-
-        QString dir = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
-        if (dir.isEmpty()) dir = QDir::homePath();
-        QDir d(dir);
-        if (!d.exists()) d.mkpath(".");
+    // Off screen first so the recording doesn't open on the menu; the
+    // toast is left in on purpose, as a marker of where it starts.
+    void startRecording() {
+        hideWithToast("Recording — open this menu again to stop");
+        if (!QProcess::startDetached("osm-record", QStringList()))
+            qWarning() << "osm-rocker: cannot start osm-record";
+    }
 
-        QString name = "screenshot-" +
-            QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".png";
+    // --stop waits for ffmpeg to finish the file
+    void stopRecording() {
+        QProcess::startDetached("osm-record", QStringList() << "--stop");
+        hideWithToast("Recording saved to ~/Videos");
+    }
 
-        QString full = d.filePath(name);
-        pix.save(full);
+    void hideWithToast(const QString &message) {
+        rockerServer->close();
+        hide();
 
-        QWidget *toast = buildToast("Screenshot saved to ~/Pictures");
+        QWidget *toast = buildToast(message);
         toast->show();
         toast->raise();
 
-        QTimer::singleShot(2000, toast, [toast](){
+        QTimer::singleShot(2000, this, [this, toast](){
             toast->close();
             toast->deleteLater();
+            close();
         });
-
-        close();
     }
 
     void openPowerMenu() {
@@ -325,17 +932,24 @@ private:
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+    // a screenshot keeps running after the overlay has closed
+    app.setQuitOnLastWindowClosed(false);
 
-    OverlayPanel o;
+    // WA_DeleteOnClose: owned by Qt once shown
+    OverlayPanel *o = new OverlayPanel;
+    QObject::connect(o, &QObject::destroyed, [](){
+        if (!ScreenGrabber::busy())
+            QCoreApplication::quit();
+    });
 
     // sized to screen WITHOUT fullscreen mode
     QRect g = QGuiApplication::primaryScreen()->geometry();
-    o.setGeometry(g);
+    o->setGeometry(g);
 
-    o.show();   // NOT showFullScreen()
-    o.raise();
-    o.activateWindow();
-    o.setFocus();
+    o->show();   // NOT showFullScreen()
+    o->raise();
+    o->activateWindow();
+    o->setFocus();
 
     return app.exec();
 }
@@ -9,7 +9,7 @@
 #include <QPushButton>
 #include <QScreen>
 #include <QTimer>
-#include <QGraphicsDropShadowEffect>
+#include <QPainter>
 #include <QMouseEvent>
 #include <QLockFile>
 #include <QDir>
@@ -21,89 +21,173 @@
 #include <QScrollerProperties>
 #include <QPropertyAnimation>
 #include <QEasingCurve>
+#include <QSocketNotifier>
+#include <QEvent>
+#include <QSet>
+#include <QHash>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QSettings>
+#include <QProcess>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+
+#include <algorithm>
 
 #include <functional>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/XShm.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "common/fdnotifier.h"
+#include "common/edgelistener.h"
+#include "common/panelshadow.h"
 
 // ───────────────────────────────────────────── X11 helpers
-static Atom getAtom(Display *dpy, const char *name) {
-    return XInternAtom(dpy, name, False);
-}
 
-static QString getWindowTitle(Display *dpy, Window win) {
-    Atom prop = getAtom(dpy, "_NET_WM_NAME");
-    Atom utf8 = getAtom(dpy, "UTF8_STRING");
+// Interned once at startup in a single round trip
+struct NetAtoms {
+    Atom clientList;
+    Atom activeWindow;
+    Atom netWmName;
+    Atom netWmIcon;
+    Atom netWmPid;
+    Atom utf8;
+};
+static NetAtoms g_atoms;
+
+static void internAtoms(Display *dpy) {
+    const char *names[] = {
+        "_NET_CLIENT_LIST", "_NET_ACTIVE_WINDOW",
+        "_NET_WM_NAME", "_NET_WM_ICON", "_NET_WM_PID", "UTF8_STRING"
+    };
+    Atom a[6];
+    XInternAtoms(dpy, const_cast<char**>(names), 6, False, a);
+    g_atoms = { a[0], a[1], a[2], a[3], a[4], a[5] };
+}
 
-    Atom type;
-    int format;
-    unsigned long nitems, after;
-    unsigned char *data = nullptr;
+// Clients can vanish between _NET_CLIENT_LIST and our next request on them;
+// the default handler would exit the whole panel on that BadWindow.
+static int ignoreXErrors(Display *, XErrorEvent *) {
+    return 0;
+}
 
-    if (XGetWindowProperty(dpy, win, prop, 0, (~0L), False, utf8,
-                           &type, &format, &nitems, &after, &data)
-        == Success && data)
-    {
-        QString out = QString::fromUtf8((char*)data);
-        XFree(data);
-        if (!out.isEmpty()) return out;
-    }
+// ───────────────────────────────────────────── Pipelined property fetch
+// Property reads go through the xcb side of the Xlib connection: every
+// GetProperty for a refresh is sent back to back and the replies are
+// collected afterwards, so N windows cost about one round trip instead of
+// 3-4 blocking Xlib calls each.
 
-    XTextProperty tp;
-    if (XGetWMName(dpy, win, &tp) && tp.value) {
-        QString out = QString::fromLatin1((char*)tp.value);
-        XFree(tp.value);
-        return out;
-    }
+static const uint32_t kNameLongs = 1024;          // 4 KiB of title is plenty
+static const uint32_t kIconLongs = 0x3fffffff;    // whole property
+static const uint32_t kClientListLongs = 4096;    // far more windows than a phone has
 
-    return "";
+static xcb_get_property_cookie_t requestProperty(
+    xcb_connection_t *c, Window win, Atom prop, Atom type, uint32_t longs)
+{
+    return xcb_get_property(c, 0, (xcb_window_t)win, (xcb_atom_t)prop,
+                            (xcb_atom_t)type, 0, longs);
 }
 
-static QString getWindowClass(Display *dpy, Window win) {
-    XClassHint hint;
-    if (XGetClassHint(dpy, win, &hint)) {
-        QString cls = hint.res_class ? QString::fromLatin1(hint.res_class) : "";
-        if (hint.res_name) XFree(hint.res_name);
-        if (hint.res_class) XFree(hint.res_class);
-        return cls.toLower();
+// Reply (or nullptr for BadWindow & co.); caller frees
+static xcb_get_property_reply_t *takeProperty(
+    xcb_connection_t *c, xcb_get_property_cookie_t cookie)
+{
+    xcb_generic_error_t *err = nullptr;
+    xcb_get_property_reply_t *r = xcb_get_property_reply(c, cookie, &err);
+    if (err) free(err);
+    if (r && r->type == XCB_NONE) {
+        free(r);
+        return nullptr;
     }
-    return "";
+    return r;
 }
 
-static QPixmap getNetWmIcon(Display *dpy, Window win, int size = 28) {
-    Atom prop = getAtom(dpy, "_NET_WM_ICON");
-
-    Atom type;
-    int format;
-    unsigned long nitems, after;
-    unsigned char *raw = nullptr;
+static QString takeTitle(xcb_connection_t *c,
+                         xcb_get_property_cookie_t netName,
+                         xcb_get_property_cookie_t wmName)
+{
+    QString out;
+
+    // both replies must be collected even if the first one wins
+    xcb_get_property_reply_t *r = takeProperty(c, netName);
+    if (r) {
+        out = QString::fromUtf8((const char*)xcb_get_property_value(r),
+                                xcb_get_property_value_length(r));
+        free(r);
+    }
 
-    if (XGetWindowProperty(dpy, win, prop, 0, (~0L), False,
-                           AnyPropertyType,
-                           &type, &format, &nitems, &after, &raw) != Success || !raw)
-    {
-        if (raw) XFree(raw);
-        return QPixmap();
+    r = takeProperty(c, wmName);
+    if (r) {
+        if (out.isEmpty())
+            out = QString::fromLatin1((const char*)xcb_get_property_value(r),
+                                      xcb_get_property_value_length(r));
+        free(r);
     }
+    return out;
+}
 
-    unsigned long *data = (unsigned long*)raw;
-    unsigned long len = nitems;
+// WM_CLASS is "res_name\0res_class\0"; we want res_class
+static QString takeClass(xcb_connection_t *c, xcb_get_property_cookie_t cookie) {
+    xcb_get_property_reply_t *r = takeProperty(c, cookie);
+    if (!r) return "";
+
+    const char *v = (const char*)xcb_get_property_value(r);
+    int len = xcb_get_property_value_length(r);
+    int nameLen = qstrnlen(v, len);
+
+    QString cls;
+    if (nameLen + 1 < len)
+        cls = QString::fromLatin1(v + nameLen + 1,
+                                  qstrnlen(v + nameLen + 1, len - nameLen - 1));
+    free(r);
+    return cls.toLower();
+}
 
-    int bestW = 0, bestH = 0;
-    unsigned long bestOffset = 0;
+// _NET_WM_ICON is a list of (width, height, width*height ARGB pixels).
+// Use the smallest entry that still covers the target size (falling back to
+// the largest one), so a 28 px card never decodes and smooth-scales 256 px.
+static QPixmap decodeNetWmIcon(const uint32_t *data, uint32_t len, int size) {
+    uint32_t bestW = 0, bestH = 0, bestOffset = 0;
 
-    unsigned long i = 0;
+    uint32_t i = 0;
     while (i + 1 < len) {
-        unsigned long w = data[i];
-        unsigned long h = data[i+1];
-        unsigned long count = w * h;
+        uint32_t w = data[i];
+        uint32_t h = data[i+1];
+        uint64_t count = (uint64_t)w * h;
 
         if (w < 1 || h < 1 || i + 2 + count > len)
             break;
 
-        if ((int)w*h > bestW * bestH) {
+        bool fits     = w >= (uint32_t)size && h >= (uint32_t)size;
+        bool bestFits = bestW >= (uint32_t)size && bestH >= (uint32_t)size;
+        bool better   = bestOffset == 0 ||
+                        (fits && (!bestFits || count < (uint64_t)bestW * bestH)) ||
+                        (!fits && !bestFits && count > (uint64_t)bestW * bestH);
+        if (better) {
             bestW = w;
             bestH = h;
             bestOffset = i + 2;
@@ -112,31 +196,689 @@ static QPixmap getNetWmIcon(Display *dpy, Window win, int size = 28) {
         i += 2 + count;
     }
 
+    if (bestOffset == 0)
+        return QPixmap();
+
+    // xcb hands us 32-bit 0xAARRGGBB words, which is exactly QImage's
+    // ARGB32 layout: copy whole rows instead of setPixel per pixel.
+    QImage img(bestW, bestH, QImage::Format_ARGB32);
+    const uint32_t *pix = data + bestOffset;
+    for (uint32_t y = 0; y < bestH; ++y)
+        memcpy(img.scanLine(y), pix + (size_t)y * bestW, bestW * sizeof(uint32_t));
+
+    if ((int)bestW != size || (int)bestH != size)
+        img = img.scaled(size,size,Qt::KeepAspectRatio,Qt::SmoothTransformation);
+
+    return QPixmap::fromImage(img);
+}
+
+static pid_t takePid(xcb_connection_t *c, xcb_get_property_cookie_t cookie) {
+    xcb_get_property_reply_t *r = takeProperty(c, cookie);
+    if (!r) return 0;
+
+    pid_t pid = 0;
+    if (r->format == 32 && xcb_get_property_value_length(r) >= 4)
+        pid = *(const uint32_t*)xcb_get_property_value(r);
+    free(r);
+    return pid;
+}
+
+static Window fetchActiveWindow(Display *dpy) {
+    xcb_connection_t *xc = XGetXCBConnection(dpy);
+    xcb_get_property_reply_t *r = takeProperty(xc, requestProperty(
+        xc, DefaultRootWindow(dpy), g_atoms.activeWindow, XA_WINDOW, 1));
+    if (!r) return 0;
+
+    Window w = 0;
+    if (r->format == 32 && xcb_get_property_value_length(r) >= 4)
+        w = *(const uint32_t*)xcb_get_property_value(r);
+    free(r);
+    return w;
+}
+
+static QPixmap takeIcon(xcb_connection_t *c, xcb_get_property_cookie_t cookie,
+                        int size = 28)
+{
+    xcb_get_property_reply_t *r = takeProperty(c, cookie);
+    if (!r) return QPixmap();
+
     QPixmap out;
-    if (bestOffset > 0) {
-        QImage img(bestW, bestH, QImage::Format_ARGB32);
-        unsigned long *pix = data + bestOffset;
-
-        for (int y = 0; y < bestH; ++y)
-        for (int x = 0; x < bestW; ++x) {
-            unsigned long p = pix[y * bestW + x];
-            img.setPixel(x,y, qRgba((p>>16)&0xFF,(p>>8)&0xFF,p&0xFF,(p>>24)&0xFF));
+    if (r->format == 32)
+        out = decodeNetWmIcon((const uint32_t*)xcb_get_property_value(r),
+                              xcb_get_property_value_length(r) / 4, size);
+    free(r);
+    return out;
+}
+
+// ───────────────────────────────────────────── Thumbnails
+// Live previews of client windows. Each tracked window is redirected with
+// XComposite so its contents stay readable in an offscreen pixmap, and
+// watched with XDamage; only damaged windows are re-captured, at most
+// kMaxFps times a second, through an MIT-SHM image reused per window.
+// Nothing is tracked while the panel is hidden.
+
+class WindowThumbnailer : public QObject {
+public:
+    static const int kThumbW = 128;
+    static const int kThumbH = 80;
+    static const int kMaxFps = 4;
+
+    explicit WindowThumbnailer(Display *dpy, QObject *parent = nullptr)
+        : QObject(parent), m_dpy(dpy), m_active(false),
+          m_damageEvent(0), m_hasShm(false), m_available(false)
+    {
+        int cEv, cErr, dErr, major = 0, minor = 2;
+        if (XCompositeQueryExtension(m_dpy, &cEv, &cErr) &&
+            XCompositeQueryVersion(m_dpy, &major, &minor) &&
+            (major > 0 || minor >= 2) &&
+            XDamageQueryExtension(m_dpy, &m_damageEvent, &dErr))
+        {
+            m_available = true;
         }
+        m_hasShm = XShmQueryExtension(m_dpy);
 
-        out = QPixmap::fromImage(img)
-                .scaled(size,size,Qt::KeepAspectRatio,Qt::SmoothTransformation);
+        m_captureTimer = new QTimer(this);
+        m_captureTimer->setSingleShot(true);
+        m_captureTimer->setInterval(1000 / kMaxFps);
+        connect(m_captureTimer, &QTimer::timeout, [this](){ capturePending(); });
     }
 
-    XFree(raw);
-    return out;
-}
+    bool available() const { return m_available; }
+
+    std::function<void(Window, const QPixmap&)> onThumbnail;
+
+    void track(Window w) {
+        if (!m_available || m_thumbs.contains(w)) return;
+        m_thumbs.insert(w, Thumb());
+        if (m_active) {
+            start(w, m_thumbs[w]);
+            capture(w, m_thumbs[w]);
+        }
+    }
+
+    void untrack(Window w) {
+        auto it = m_thumbs.find(w);
+        if (it == m_thumbs.end()) return;
+        stop(w, it.value());
+        m_thumbs.erase(it);
+    }
+
+    // Redirect + damage only while somebody can see the thumbnails
+    void setActive(bool on) {
+        if (!m_available || on == m_active) return;
+        m_active = on;
+
+        for (auto it = m_thumbs.begin(); it != m_thumbs.end(); ++it) {
+            if (on) {
+                start(it.key(), it.value());
+                capture(it.key(), it.value());
+            } else {
+                stop(it.key(), it.value());
+            }
+        }
+        if (!on) m_captureTimer->stop();
+        XFlush(m_dpy);
+    }
+
+    // Returns true if the event was a damage notification for us
+    bool handleEvent(const XEvent &ev) {
+        if (!m_available || ev.type != m_damageEvent + XDamageNotify)
+            return false;
+
+        const XDamageNotifyEvent *de =
+            reinterpret_cast<const XDamageNotifyEvent*>(&ev);
+        auto it = m_thumbs.find(de->drawable);
+        if (it != m_thumbs.end() && it->damage == de->damage) {
+            it->pending = true;
+            if (!m_captureTimer->isActive())
+                m_captureTimer->start();
+        }
+        return true;
+    }
+
+private:
+    struct Thumb {
+        Damage damage = 0;
+        bool pending = false;
+        XImage *image = nullptr;      // SHM-backed, reused while size matches
+        XShmSegmentInfo shm;
+    };
+
+    void start(Window w, Thumb &t) {
+        XCompositeRedirectWindow(m_dpy, w, CompositeRedirectAutomatic);
+        // NonEmpty: one event, then silence until we subtract on capture
+        t.damage = XDamageCreate(m_dpy, w, XDamageReportNonEmpty);
+        t.pending = false;
+    }
+
+    void stop(Window w, Thumb &t) {
+        if (t.damage) {
+            XDamageDestroy(m_dpy, t.damage);
+            XCompositeUnredirectWindow(m_dpy, w, CompositeRedirectAutomatic);
+            t.damage = 0;
+        }
+        releaseImage(t);
+        t.pending = false;
+    }
+
+    void releaseImage(Thumb &t) {
+        if (!t.image) return;
+        XShmDetach(m_dpy, &t.shm);
+        shmdt(t.shm.shmaddr);
+        t.image->data = nullptr;
+        XDestroyImage(t.image);
+        t.image = nullptr;
+    }
+
+    bool ensureImage(Thumb &t, const XWindowAttributes &wa) {
+        if (t.image && t.image->width == wa.width &&
+            t.image->height == wa.height && t.image->depth == wa.depth)
+            return true;
+
+        releaseImage(t);
+
+        XImage *img = XShmCreateImage(m_dpy, wa.visual, wa.depth, ZPixmap,
+                                      nullptr, &t.shm, wa.width, wa.height);
+        if (!img) return false;
+
+        t.shm.shmid = shmget(IPC_PRIVATE, img->bytes_per_line * img->height,
+                             IPC_CREAT | 0600);
+        if (t.shm.shmid < 0) {
+            XDestroyImage(img);
+            return false;
+        }
+        t.shm.shmaddr = img->data = (char*)shmat(t.shm.shmid, nullptr, 0);
+        t.shm.readOnly = False;
+
+        bool ok = t.shm.shmaddr != (char*)-1 && XShmAttach(m_dpy, &t.shm);
+        XSync(m_dpy, False);
+        // segment goes away once both we and the server have detached
+        shmctl(t.shm.shmid, IPC_RMID, nullptr);
+
+        if (!ok) {
+            if (t.shm.shmaddr != (char*)-1) shmdt(t.shm.shmaddr);
+            img->data = nullptr;
+            XDestroyImage(img);
+            return false;
+        }
+
+        t.image = img;
+        return true;
+    }
+
+    void capturePending() {
+        for (auto it = m_thumbs.begin(); it != m_thumbs.end(); ++it) {
+            if (it->pending)
+                capture(it.key(), it.value());
+        }
+    }
+
+    void capture(Window w, Thumb &t) {
+        t.pending = false;
+        if (!t.damage) return;
+
+        XDamageSubtract(m_dpy, t.damage, None, None);
+
+        XWindowAttributes wa;
+        if (!XGetWindowAttributes(m_dpy, w, &wa) || wa.map_state != IsViewable)
+            return;     // keep the last thumbnail for unmapped windows
+        if (wa.width < 1 || wa.height < 1 || (wa.depth != 24 && wa.depth != 32))
+            return;
+
+        Pixmap pm = XCompositeNameWindowPixmap(m_dpy, w);
+        if (!pm) return;
+
+        XImage *img = nullptr;
+        bool shared = false;
+        if (m_hasShm && ensureImage(t, wa) &&
+            XShmGetImage(m_dpy, pm, t.image, 0, 0, AllPlanes))
+        {
+            img = t.image;
+            shared = true;
+        } else {
+            img = XGetImage(m_dpy, pm, 0, 0, wa.width, wa.height,
+                            AllPlanes, ZPixmap);
+        }
+        XFreePixmap(m_dpy, pm);
+
+        if (!img) return;
+
+        if (img->bits_per_pixel == 32) {
+            QImage frame(reinterpret_cast<const uchar*>(img->data),
+                         img->width, img->height, img->bytes_per_line,
+                         wa.depth == 32 ? QImage::Format_ARGB32_Premultiplied
+                                        : QImage::Format_RGB32);
+
+            // Cheap nearest-neighbour pass down to 2x, then one smooth pass,
+            // so cost follows the thumbnail size rather than the window size.
+            QSize mid = frame.size().scaled(kThumbW * 2, kThumbH * 2,
+                                            Qt::KeepAspectRatio);
+            QImage small = frame.width() > mid.width()
+                ? frame.scaled(mid, Qt::IgnoreAspectRatio, Qt::FastTransformation)
+                : frame.copy();
+            small = small.scaled(kThumbW, kThumbH, Qt::KeepAspectRatio,
+                                 Qt::SmoothTransformation);
+
+            if (onThumbnail)
+                onThumbnail(w, QPixmap::fromImage(small));
+        }
+
+        if (!shared) XDestroyImage(img);
+    }
+
+    Display *m_dpy;
+    bool m_active;
+    int m_damageEvent;
+    bool m_hasShm;
+    bool m_available;
+    QTimer *m_captureTimer;
+    QHash<Window, Thumb> m_thumbs;
+};
+
+// ───────────────────────────────────────────── Process usage
+// CPU% and memory of each window's process tree (_NET_WM_PID plus its
+// descendants via /proc/<pid>/task/<tid>/children). CPU comes from the
+// utime+stime delta in /proc/<pid>/stat between ticks; Rss/Pss come from
+// smaps_rollup, which is costlier for the kernel and so is read every
+// kMemEvery ticks. Only runs while the panel is visible.
+
+struct ProcUsage {
+    double cpu = 0;         // percent of one core
+    qint64 rssKb = 0;
+    qint64 pssKb = 0;
+    bool valid = false;
+};
+
+class ProcessSampler : public QObject {
+public:
+    static const int kIntervalMs = 1000;
+    static const int kMemEvery   = 3;
+
+    explicit ProcessSampler(QObject *parent = nullptr)
+        : QObject(parent), m_tick(0), m_clk(sysconf(_SC_CLK_TCK))
+    {
+        if (m_clk <= 0) m_clk = 100;
+        m_timer = new QTimer(this);
+        m_timer->setInterval(kIntervalMs);
+        connect(m_timer, &QTimer::timeout, [this](){ sample(); });
+    }
+
+    std::function<void()> onSample;
+
+    void setWindows(const QHash<Window, pid_t> &pids) {
+        m_pids = pids;
+        for (const Window w : m_usage.keys())
+            if (!m_pids.contains(w)) m_usage.remove(w);
+    }
+
+    void setActive(bool on) {
+        if (on == m_timer->isActive()) return;
+        if (on) {
+            // first tick only primes the CPU counters
+            m_prevTicks.clear();
+            m_tick = 0;
+            m_clock.start();
+            sample();
+            m_timer->start();
+        } else {
+            m_timer->stop();
+        }
+    }
+
+    ProcUsage usage(Window w) const { return m_usage.value(w); }
+
+private:
+    static QByteArray readProc(const QString &path) {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+        return f.readAll();
+    }
+
+    // utime + stime in clock ticks; -1 if the process is gone
+    static qint64 cpuTicks(pid_t pid) {
+        QByteArray stat = readProc(QString("/proc/%1/stat").arg(pid));
+        int close = stat.lastIndexOf(')');       // comm may contain spaces
+        if (close < 0) return -1;
+        QList<QByteArray> f = stat.mid(close + 2).split(' ');
+        if (f.size() < 13) return -1;
+        return f[11].toLongLong() + f[12].toLongLong();
+    }
+
+    static void memory(pid_t pid, qint64 &rss, qint64 &pss) {
+        QByteArray roll = readProc(QString("/proc/%1/smaps_rollup").arg(pid));
+        for (const QByteArray &line : roll.split('\n')) {
+            if (line.startsWith("Rss:"))
+                rss += line.mid(4).trimmed().split(' ').value(0).toLongLong();
+            else if (line.startsWith("Pss:"))
+                pss += line.mid(4).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+
+    static void collectTree(pid_t pid, QVector<pid_t> &out, int depth = 0) {
+        if (pid <= 0 || depth > 16 || out.contains(pid)) return;
+        out.append(pid);
+
+        QDir tasks(QString("/proc/%1/task").arg(pid));
+        for (const QString &tid : tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QByteArray kids = readProc(tasks.filePath(tid + "/children"));
+            for (const QByteArray &k : kids.simplified().split(' '))
+                if (!k.isEmpty()) collectTree(k.toInt(), out, depth + 1);
+        }
+    }
+
+    void sample() {
+        double elapsed = m_clock.restart() / 1000.0;
+        bool readMem = (m_tick++ % kMemEvery) == 0;
+
+        QHash<pid_t, qint64> ticks;
+        QHash<pid_t, QVector<pid_t>> trees;   // windows of one app share a tree
+
+        for (auto it = m_pids.begin(); it != m_pids.end(); ++it) {
+            pid_t root = it.value();
+            if (root <= 0) continue;
+
+            if (!trees.contains(root)) {
+                QVector<pid_t> tree;
+                collectTree(root, tree);
+                trees.insert(root, tree);
+            }
+
+            ProcUsage &u = m_usage[it.key()];
+            double cpu = 0;
+            bool primed = false;
+            qint64 rss = 0, pss = 0;
+
+            for (pid_t pid : trees[root]) {
+                if (!ticks.contains(pid)) ticks.insert(pid, cpuTicks(pid));
+                qint64 now = ticks[pid];
+                if (now < 0) continue;
+
+                auto prev = m_prevTicks.constFind(pid);
+                if (prev != m_prevTicks.constEnd() && elapsed > 0) {
+                    cpu += (now - prev.value()) * 100.0 / m_clk / elapsed;
+                    primed = true;
+                }
+                if (readMem) memory(pid, rss, pss);
+            }
+
+            if (primed) u.cpu = qMax(0.0, cpu);
+            if (readMem) {
+                u.rssKb = rss;
+                u.pssKb = pss;
+            }
+            u.valid = primed || u.valid;
+        }
+
+        // keep only live pids so the table tracks the current trees
+        m_prevTicks.clear();
+        for (auto it = ticks.begin(); it != ticks.end(); ++it)
+            if (it.value() >= 0) m_prevTicks.insert(it.key(), it.value());
+
+        if (onSample) onSample();
+    }
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    int m_tick;
+    long m_clk;
+    QHash<Window, pid_t> m_pids;
+    QHash<pid_t, qint64> m_prevTicks;
+    QHash<Window, ProcUsage> m_usage;
+};
+
+// ───────────────────────────────────────────── Background freezer
+// Optional (~/.config/Alternix/osm-freezer.conf, [Freezer] enabled=true).
+// osm-launcher then starts every app in its own transient systemd scope
+// under osm-apps.slice, i.e. a cgroup v2 leaf in the user's delegated
+// subtree. Here we remember when each scope last owned the active window
+// and write cgroup.freeze for scopes idle longer than idleSeconds. A scope
+// is thawed as soon as one of its windows is activated, and never frozen
+// while whitelisted (by program name) or while PulseAudio reports one of
+// its processes playing.
+
+class AppFreezer : public QObject {
+public:
+    static const int kCheckMs = 15000;
+
+    explicit AppFreezer(Display *dpy, QObject *parent = nullptr)
+        : QObject(parent), m_dpy(dpy), m_audioProbe(nullptr)
+    {
+        QSettings cfg(QDir::homePath() + "/.config/Alternix/osm-freezer.conf",
+                      QSettings::IniFormat);
+        m_enabled   = cfg.value("Freezer/enabled", false).toBool();
+        m_idleMs    = cfg.value("Freezer/idleSeconds", 120).toInt() * 1000LL;
+        m_whitelist = cfg.value("Freezer/whitelist",
+                                QStringList{ "plasma-dialer", "spacebar", "vlc" })
+                         .toStringList();
+
+        uid_t uid = getuid();
+        m_sliceDir = QString("/sys/fs/cgroup/user.slice/user-%1.slice/"
+                             "user@%1.service/osm-apps.slice").arg(uid);
+
+        if (!m_enabled) return;
+
+        // anything left frozen by a previous instance comes back first
+        for (const QString &cg : scopes())
+            writeFreeze(cg, false);
+
+        m_timer = new QTimer(this);
+        m_timer->setInterval(kCheckMs);
+        connect(m_timer, &QTimer::timeout, [this](){ check(); });
+        m_timer->start();
+    }
+
+    ~AppFreezer() override {
+        for (const QString &cg : m_frozen)
+            writeFreeze(cg, false);
+    }
+
+    bool enabled() const { return m_enabled; }
+
+    // Call when _NET_ACTIVE_WINDOW changed (or is about to)
+    void noteActive(Window w) {
+        if (!m_enabled || !w) return;
+        QString cg = cgroupOf(pidOf(w));
+        m_activeCg = cg;
+        if (cg.isEmpty()) return;
+
+        m_lastActive[cg] = QDateTime::currentMSecsSinceEpoch();
+        setFrozen(cg, false);
+    }
+
+private:
+    pid_t pidOf(Window w) {
+        xcb_connection_t *xc = XGetXCBConnection(m_dpy);
+        xcb_get_property_cookie_t ck = xcb_get_property(
+            xc, 0, w, g_atoms.netWmPid, XA_CARDINAL, 0, 1);
+        return takePid(xc, ck);
+    }
+
+    // Our scope's cgroup dir for pid, or empty if it is not one of ours
+    QString cgroupOf(pid_t pid) const {
+        if (pid <= 0) return QString();
+        QFile f(QString("/proc/%1/cgroup").arg(pid));
+        if (!f.open(QIODevice::ReadOnly)) return QString();
+
+        for (const QByteArray &line : f.readAll().split('\n')) {
+            if (!line.startsWith("0::")) continue;
+            QString path = "/sys/fs/cgroup" + QString::fromUtf8(line.mid(3));
+            if (path.startsWith(m_sliceDir + "/osm-app-"))
+                return path;
+        }
+        return QString();
+    }
+
+    QStringList scopes() const {
+        QStringList out;
+        QDir slice(m_sliceDir);
+        for (const QString &d : slice.entryList({ "osm-app-*.scope" }, QDir::Dirs))
+            out << slice.filePath(d);
+        return out;
+    }
+
+    // unit is osm-app-<program>-<stamp>.scope (see osm-launcher)
+    bool whitelisted(const QString &cg) const {
+        QString unit = QFileInfo(cg).fileName();
+        QString prog = unit.mid(8, unit.lastIndexOf('-') - 8);
+        return m_whitelist.contains(prog, Qt::CaseInsensitive);
+    }
+
+    static bool writeFreeze(const QString &cg, bool on) {
+        QFile f(cg + "/cgroup.freeze");
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        return f.write(on ? "1" : "0") == 1;
+    }
+
+    void setFrozen(const QString &cg, bool on) {
+        if (on == m_frozen.contains(cg)) return;
+        if (!writeFreeze(cg, on)) return;
+        if (on) m_frozen.insert(cg);
+        else    m_frozen.remove(cg);
+    }
+
+    void check() {
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        QStringList live = scopes();
+
+        // forget scopes that have exited
+        for (const QString &cg : m_lastActive.keys())
+            if (!live.contains(cg)) m_lastActive.remove(cg);
+        for (const QString &cg : m_frozen.values())
+            if (!live.contains(cg)) m_frozen.remove(cg);
+
+        QStringList candidates;
+        for (const QString &cg : live) {
+            if (!m_lastActive.contains(cg)) {
+                // new scope: give it a full idle period from now
+                m_lastActive.insert(cg, now);
+                continue;
+            }
+            if (cg == m_activeCg || m_frozen.contains(cg) || whitelisted(cg))
+                continue;
+            if (now - m_lastActive.value(cg) >= m_idleMs)
+                candidates << cg;
+        }
+
+        if (candidates.isEmpty() || m_audioProbe) return;
+        probeAudioThenFreeze(candidates);
+    }
+
+    // pactl runs asynchronously; freezing waits for its answer. Without a
+    // clean answer nothing is frozen: an unknown player must not go silent.
+    void probeAudioThenFreeze(const QStringList &candidates) {
+        m_audioProbe = new QProcess(this);
+        QProcess *p = m_audioProbe;
+
+        auto done = [this, p, candidates](bool ok) {
+            if (m_audioProbe != p) return;
+            m_audioProbe = nullptr;
+            if (!ok) {
+                p->deleteLater();
+                return;
+            }
+
+            QSet<pid_t> playing;
+            bool corked = true;
+            for (const QString &raw : QString::fromUtf8(p->readAllStandardOutput()).split('\n')) {
+                QString line = raw.trimmed();
+                if (line.startsWith("Sink Input #"))
+                    corked = true;
+                else if (line.startsWith("Corked:"))
+                    corked = line.endsWith("yes");
+                else if (!corked && line.startsWith("application.process.id"))
+                    playing.insert(line.section('"', 1, 1).toInt());
+            }
+            p->deleteLater();
+
+            for (const QString &cg : candidates) {
+                if (cg == m_activeCg) continue;
+
+                bool audible = false;
+                QFile procs(cg + "/cgroup.procs");
+                if (procs.open(QIODevice::ReadOnly))
+                    for (const QByteArray &pid : procs.readAll().split('\n'))
+                        if (!pid.isEmpty() && playing.contains(pid.toInt()))
+                            audible = true;
+
+                if (!audible) setFrozen(cg, true);
+            }
+        };
+
+        connect(p, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                [done](int code, QProcess::ExitStatus st) {
+                    done(st == QProcess::NormalExit && code == 0);
+                });
+        connect(p, &QProcess::errorOccurred, [done](QProcess::ProcessError){ done(false); });
+
+        // the field names parsed above are only stable untranslated
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert("LC_ALL", "C");
+        p->setProcessEnvironment(env);
+        p->start("pactl", { "list", "sink-inputs" });
+    }
+
+    Display *m_dpy;
+    bool m_enabled;
+    qint64 m_idleMs;
+    QStringList m_whitelist;
+    QString m_sliceDir;
+    QString m_activeCg;
+    QTimer *m_timer = nullptr;
+    QProcess *m_audioProbe;
+    QHash<QString, qint64> m_lastActive;
+    QSet<QString> m_frozen;
+};
+
+// ───────────────────────────────────────────── Activity log
+// When each client last held _NET_ACTIVE_WINDOW, published for osm-lmkd
+// as "<window> <epoch-ms>" lines in $XDG_RUNTIME_DIR/osm-running.activity.
+// Rewritten atomically on focus changes only; capped to recent windows.
+
+class ActivityLog {
+public:
+    static const int kMaxEntries = 64;
+
+    ActivityLog()
+        : m_path(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+                 + "/osm-running.activity") {}
+
+    void noteActive(Window w) {
+        if (!w) return;
+        m_lastActive[w] = QDateTime::currentMSecsSinceEpoch();
+
+        if (m_lastActive.size() > kMaxEntries) {
+            QList<qint64> times = m_lastActive.values();
+            std::sort(times.begin(), times.end());
+            qint64 cutoff = times[times.size() - kMaxEntries];
+            for (const Window k : m_lastActive.keys())
+                if (m_lastActive.value(k) < cutoff) m_lastActive.remove(k);
+        }
+
+        QSaveFile f(m_path);
+        if (!f.open(QIODevice::WriteOnly)) return;
+        for (auto it = m_lastActive.begin(); it != m_lastActive.end(); ++it)
+            f.write(QString("0x%1 %2\n").arg(it.key(), 0, 16).arg(it.value()).toLatin1());
+        f.commit();
+    }
+
+private:
+    QString m_path;
+    QHash<Window, qint64> m_lastActive;
+};
 
 // ───────────────────────────────────────────── Structures
 
 struct WindowInfo {
-    Window id;
+    Window id = 0;
     QString title;
     QString appClass;
+    QPixmap icon;           // decoded _NET_WM_ICON, kept until it changes
+    pid_t pid = 0;          // _NET_WM_PID, fetched along with the class
+
+    // set from PropertyNotify; only stale fields are fetched again
+    bool titleStale = true;
+    bool classStale = true;
+    bool iconStale  = true;
 };
 
 class SidePanel;
@@ -150,6 +892,7 @@ public:
     explicit SidePanel(Display *dpy, QWidget *parent=nullptr);
 
     void refreshWindows();
+    void refreshIfDirty();
     void activateWindow(Window w);
     void closeAppWindow(Window w);
     void handleEntryActivateAndClose(Window w);
@@ -157,6 +900,8 @@ public:
 
     int computeRequiredWidth(const QStringList &titles) {
         int base = 160;
+        if (m_thumbs->available())
+            base += WindowThumbnailer::kThumbW + 8;
         QFont f; f.setPointSize(32);
         QFontMetrics fm(f);
         int max = 0;
@@ -170,13 +915,62 @@ public:
 public:
     std::function<void()> onClose;
 
+protected:
+    void showEvent(QShowEvent *e) override {
+        m_thumbs->setActive(true);
+        m_sampler->setActive(true);
+        QWidget::showEvent(e);
+    }
+
+    void hideEvent(QHideEvent *e) override {
+        m_thumbs->setActive(false);
+        m_sampler->setActive(false);
+        QWidget::hideEvent(e);
+    }
+
+    // shadow, painted behind m_inner
+    void paintEvent(QPaintEvent *e) override {
+        Q_UNUSED(e);
+        static const int radii[4] = { 0, 26, 26, 0 };
+        QPainter p(this);
+        PanelShadow::paintPanel(p, m_inner->geometry(), radii);
+    }
+
 private:
+    enum SortMode { SortClientList, SortCpu, SortMemory };
+
+    void handleXEvents();
+    void scheduleRefresh();
+    void forgetWindow(Window w);
+    void applyOrder();
+    void updateSortButton();
+
     Display *m_dpy;
     QWidget *m_inner;
     QScrollArea *m_scroll;
     QVBoxLayout *m_list;
     int m_width;
     int m_maxH;
+
+    // event-driven updates: root + client PropertyNotify via the X socket
+    QSocketNotifier *m_xNotifier;
+    QTimer *m_refreshTimer;
+    bool m_dirty;
+
+    // every client we have selected PropertyChangeMask on, and its card
+    // (windows filtered out of the list have info but no card)
+    QHash<Window, WindowInfo> m_infos;
+    QHash<Window, WindowCard*> m_cards;
+
+    WindowThumbnailer *m_thumbs;
+
+    // cards in _NET_CLIENT_LIST order; applyOrder() lays them out per m_sort
+    QVector<Window> m_order;
+    ProcessSampler *m_sampler;
+    AppFreezer *m_freezer;
+    ActivityLog m_activity;
+    SortMode m_sort;
+    QPushButton *m_sortBtn;
 };
 
 // ───────────────────────────────────────────── WindowCard
@@ -185,6 +979,10 @@ class WindowCard : public QFrame {
 public:
     WindowCard(SidePanel*, Display*, const WindowInfo&, Window active, QWidget *parent=nullptr);
 
+    void setInfo(const WindowInfo &info);
+    void setThumbnail(const QPixmap &px);
+    void setUsage(const ProcUsage &u);
+
 protected:
     void mousePressEvent(QMouseEvent *e) override;
 
@@ -192,13 +990,16 @@ private:
     SidePanel *m_panel;
     Display *m_dpy;
     WindowInfo m_info;
+    QLabel *m_thumbLabel;
+    QLabel *m_iconLabel;
     QLabel *m_titleLabel;
+    QLabel *m_usageLabel;
 };
 
 // ───────────────────────────────────────────── SidePanel impl
 
 SidePanel::SidePanel(Display *dpy, QWidget *parent)
-    : QWidget(parent), m_dpy(dpy)
+    : QWidget(parent), m_dpy(dpy), m_dirty(true), m_sort(SortClientList)
 {
     setWindowFlag(Qt::WindowDoesNotAcceptFocus,true);
     setFocusPolicy(Qt::NoFocus);
@@ -230,6 +1031,23 @@ SidePanel::SidePanel(Display *dpy, QWidget *parent)
     QVBoxLayout *inner = new QVBoxLayout(m_inner);
     inner->setContentsMargins(16, 16, 16, 16);
 
+    // cycles list order: WM order → CPU → memory
+    m_sortBtn = new QPushButton(m_inner);
+    m_sortBtn->setFixedHeight(40);
+    m_sortBtn->setFocusPolicy(Qt::NoFocus);
+    m_sortBtn->setStyleSheet(
+        "QPushButton{color:white;background:#00000099;border:none;"
+        "border-radius:14px;font-size:20px;padding:0 14px;}"
+        "QPushButton:pressed{background:#550000;}"
+    );
+    connect(m_sortBtn, &QPushButton::clicked, [this](){
+        m_sort = SortMode((m_sort + 1) % 3);
+        updateSortButton();
+        applyOrder();
+    });
+    updateSortButton();
+    inner->addWidget(m_sortBtn, 0, Qt::AlignRight);
+
     m_scroll = new QScrollArea(m_inner);
     m_scroll->setWidgetResizable(true);
     m_scroll->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -252,26 +1070,131 @@ SidePanel::SidePanel(Display *dpy, QWidget *parent)
     inner->addWidget(m_scroll);
     outer->addWidget(m_inner);
 
-    // shadow
-    QGraphicsDropShadowEffect *sh = new QGraphicsDropShadowEffect(this);
-    sh->setBlurRadius(32);
-    sh->setOffset(0, 0);
-    sh->setColor(QColor(0, 0, 0, 220));
-    m_inner->setGraphicsEffect(sh);
+    // No polling: the WM tells us about list/focus changes on the root,
+    // clients tell us about title/icon changes on their own windows.
+    XSelectInput(m_dpy, DefaultRootWindow(m_dpy), PropertyChangeMask);
+    XFlush(m_dpy);
+
+    // A burst of PropertyNotify (e.g. a browser retitling per keystroke)
+    // collapses into a single refresh.
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(30);
+    connect(m_refreshTimer, &QTimer::timeout, [this](){ refreshWindows(); });
+
+    m_xNotifier = new FdNotifier(ConnectionNumber(m_dpy), [this](){ handleXEvents(); }, this);
+
+    m_thumbs = new WindowThumbnailer(m_dpy, this);
+    m_thumbs->onThumbnail = [this](Window w, const QPixmap &px) {
+        if (WindowCard *card = m_cards.value(w))
+            card->setThumbnail(px);
+    };
 
-    QTimer *t = new QTimer(this);
-    t->setInterval(600);
-    connect(t, &QTimer::timeout, [this](){ refreshWindows(); });
-    t->start();
+    m_freezer = new AppFreezer(m_dpy, this);
+
+    m_sampler = new ProcessSampler(this);
+    m_sampler->onSample = [this]() {
+        for (auto it = m_cards.begin(); it != m_cards.end(); ++it)
+            it.value()->setUsage(m_sampler->usage(it.key()));
+        if (m_sort != SortClientList)
+            applyOrder();
+    };
 
     refreshWindows();
 }
 
+void SidePanel::handleXEvents() {
+    while (XPending(m_dpy)) {
+        XEvent ev;
+        XNextEvent(m_dpy, &ev);
+        if (m_thumbs->handleEvent(ev)) continue;
+        if (ev.type != PropertyNotify) continue;
+
+        const XPropertyEvent &pe = ev.xproperty;
+        if (pe.window == DefaultRootWindow(m_dpy)) {
+            // focus is tracked even while hidden: it drives app freezing
+            // and osm-lmkd's choice of victim
+            if (pe.atom == g_atoms.activeWindow) {
+                Window active = fetchActiveWindow(m_dpy);
+                m_freezer->noteActive(active);
+                m_activity.noteActive(active);
+            }
+            if (pe.atom == g_atoms.clientList || pe.atom == g_atoms.activeWindow)
+                scheduleRefresh();
+            continue;
+        }
+
+        auto it = m_infos.find(pe.window);
+        if (it == m_infos.end()) continue;
+
+        if (pe.atom == g_atoms.netWmName || pe.atom == XA_WM_NAME)
+            it->titleStale = true;
+        else if (pe.atom == XA_WM_CLASS)
+            it->classStale = true;
+        else if (pe.atom == g_atoms.netWmIcon)
+            it->iconStale = true;
+        else
+            continue;
+
+        scheduleRefresh();
+    }
+}
+
+// While hidden nothing is rendered, so just remember that the list is stale
+// and rebuild it once when the panel is about to be shown.
+void SidePanel::scheduleRefresh() {
+    m_dirty = true;
+    if (isVisible() && !m_refreshTimer->isActive())
+        m_refreshTimer->start();
+}
+
+void SidePanel::refreshIfDirty() {
+    if (m_dirty)
+        refreshWindows();
+}
+
+// Destroyed windows drop their event selection on their own; only the
+// card and cached properties need to go.
+void SidePanel::forgetWindow(Window w) {
+    m_thumbs->untrack(w);
+    if (WindowCard *card = m_cards.take(w)) {
+        m_list->removeWidget(card);
+        card->deleteLater();
+    }
+    m_infos.remove(w);
+}
+
+void SidePanel::updateSortButton() {
+    static const char *labels[] = { "⇅ Default", "⇅ CPU", "⇅ Memory" };
+    m_sortBtn->setText(labels[m_sort]);
+}
+
+void SidePanel::applyOrder() {
+    QVector<Window> order = m_order;
+    if (m_sort != SortClientList) {
+        std::stable_sort(order.begin(), order.end(), [this](Window a, Window b) {
+            ProcUsage ua = m_sampler->usage(a), ub = m_sampler->usage(b);
+            if (m_sort == SortCpu) return ua.cpu > ub.cpu;
+            return qMax(ua.pssKb, ua.rssKb) > qMax(ub.pssKb, ub.rssKb);
+        });
+    }
+
+    for (int i = 0; i < order.size(); i++) {
+        WindowCard *card = m_cards.value(order[i]);
+        if (!card || m_list->indexOf(card) == i) continue;
+        m_list->removeWidget(card);
+        m_list->insertWidget(i, card);
+    }
+}
+
 void SidePanel::activateWindow(Window w) {
+    // a frozen app must be running again before it is asked to repaint
+    m_freezer->noteActive(w);
+
     XRaiseWindow(m_dpy, w);
     XSetInputFocus(m_dpy, w, RevertToPointerRoot, CurrentTime);
 
-    Atom act = getAtom(m_dpy,"_NET_ACTIVE_WINDOW");
+    Atom act = g_atoms.activeWindow;
     Window root = DefaultRootWindow(m_dpy);
 
     XEvent e; memset(&e,0,sizeof(e));
@@ -288,6 +1211,7 @@ void SidePanel::activateWindow(Window w) {
 }
 
 void SidePanel::closeAppWindow(Window w) {
+    m_freezer->noteActive(w);     // thaw so it can see the disconnect and exit
     XKillClient(m_dpy,w);
     XFlush(m_dpy);
     refreshWindows();
@@ -304,7 +1228,7 @@ void SidePanel::handleEntryActivateAndClose(Window w) {
 
 void SidePanel::resizeToItems(int count) {
     const int cardH = 120;
-    int h = count * cardH + 60;
+    int h = count * cardH + 60 + 48;    // + sort button row
 
     h = qBound(120, h, m_maxH);
 
@@ -315,68 +1239,141 @@ void SidePanel::resizeToItems(int count) {
 }
 
 void SidePanel::refreshWindows() {
-    Atom listA = getAtom(m_dpy,"_NET_CLIENT_LIST");
+    m_dirty = false;
+    xcb_connection_t *xc = XGetXCBConnection(m_dpy);
+    Window root = DefaultRootWindow(m_dpy);
 
-    Atom type;
-    int format;
-    unsigned long n, after;
-    unsigned char *data=nullptr;
+    // client list + active window: one round trip
+    xcb_get_property_cookie_t listCk =
+        requestProperty(xc, root, g_atoms.clientList, XA_WINDOW, kClientListLongs);
+    xcb_get_property_cookie_t activeCk =
+        requestProperty(xc, root, g_atoms.activeWindow, XA_WINDOW, 1);
+
+    std::vector<Window> wins;
+    bool haveList = false;
+    if (xcb_get_property_reply_t *r = takeProperty(xc, listCk)) {
+        const uint32_t *ids = (const uint32_t*)xcb_get_property_value(r);
+        int n = r->format == 32 ? xcb_get_property_value_length(r) / 4 : 0;
+        wins.assign(ids, ids + n);
+        haveList = true;
+        free(r);
+    }
 
-    if(XGetWindowProperty(m_dpy,DefaultRootWindow(m_dpy),
-                          listA,0,(~0L),False,XA_WINDOW,
-                          &type,&format,&n,&after,&data)!=Success || !data)
-    {
-        if(data) XFree(data);
-        return;
+    Window active=0;
+    if (xcb_get_property_reply_t *r = takeProperty(xc, activeCk)) {
+        if (r->format == 32 && xcb_get_property_value_length(r) >= 4)
+            active = *(const uint32_t*)xcb_get_property_value(r);
+        free(r);
     }
 
-    Window *wins=(Window*)data;
+    if (!haveList) return;
 
-    // active window
-    Atom actA=getAtom(m_dpy,"_NET_ACTIVE_WINDOW");
-    unsigned char *awD=nullptr;
-    unsigned long ni,ba;
-    Window active=0;
-    if(XGetWindowProperty(m_dpy,DefaultRootWindow(m_dpy),
-                          actA,0,(~0L),False,AnyPropertyType,
-                          &type,&format,&ni,&ba,&awD)==Success && awD)
-    {
-        active=*(Window*)awD;
-        XFree(awD);
+    // drop windows that left the client list
+    QSet<Window> present;
+    for (Window w : wins)
+        if(w) present.insert(w);
+
+    for (const Window w : m_infos.keys())
+        if (!present.contains(w)) forgetWindow(w);
+
+    // issue every stale property request up front...
+    struct Pending {
+        Window win;
+        bool title, cls, icon;
+        xcb_get_property_cookie_t netName, wmName, wmClass, netPid, netIcon;
+    };
+    std::vector<Pending> pending;
+    QSet<Window> changed;
+
+    for (Window w : wins) {
+        if(!w) continue;
+
+        auto found = m_infos.find(w);
+        if (found == m_infos.end()) {
+            // select before the first fetch so no change slips in between
+            XSelectInput(m_dpy, w, PropertyChangeMask);
+            WindowInfo fresh;
+            fresh.id = w;
+            found = m_infos.insert(w, fresh);
+        }
+        const WindowInfo &info = found.value();
+        if (!info.titleStale && !info.classStale && !info.iconStale)
+            continue;
+
+        Pending p{ w, info.titleStale, info.classStale, info.iconStale, {}, {}, {}, {}, {} };
+        if (p.title) {
+            p.netName = requestProperty(xc, w, g_atoms.netWmName, g_atoms.utf8, kNameLongs);
+            p.wmName  = requestProperty(xc, w, XA_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, kNameLongs);
+        }
+        if (p.cls) {
+            p.wmClass = requestProperty(xc, w, XA_WM_CLASS, XA_STRING, kNameLongs);
+            p.netPid  = requestProperty(xc, w, g_atoms.netWmPid, XA_CARDINAL, 1);
+        }
+        if (p.icon)
+            p.netIcon = requestProperty(xc, w, g_atoms.netWmIcon, XA_CARDINAL, kIconLongs);
+        pending.push_back(p);
+        changed.insert(w);
     }
 
-    // clear list
-    QLayoutItem *it;
-    while((it=m_list->takeAt(0))) {
-        if(it->widget()) it->widget()->deleteLater();
-        delete it;
+    // ...then collect the replies in order
+    for (const Pending &p : pending) {
+        WindowInfo &info = m_infos[p.win];
+        if (p.title) {
+            info.title = takeTitle(xc, p.netName, p.wmName);
+            info.titleStale = false;
+        }
+        if (p.cls) {
+            info.appClass = takeClass(xc, p.wmClass);
+            info.pid = takePid(xc, p.netPid);
+            info.classStale = false;
+        }
+        if (p.icon) {
+            info.icon = takeIcon(xc, p.netIcon, 28);
+            info.iconStale = false;
+        }
     }
 
     QStringList titles;
+    QHash<Window, pid_t> pids;
+    m_order.clear();
     int count = 0;
 
-    // collect windows
-    for(unsigned long i=0;i<n;i++) {
-        Window w=wins[i];
+    // update cards in client-list order
+    for (Window w : wins) {
         if(!w) continue;
+        const WindowInfo &info = m_infos[w];
+
+        const QString lower = info.title.toLower();
+        if (info.title.isEmpty() ||
+            lower.contains("osm-running") ||
+            lower.contains("osm-launcher") ||
+            lower.contains("wosp-shell"))
+        {
+            m_thumbs->untrack(w);
+            if (WindowCard *card = m_cards.take(w)) {
+                m_list->removeWidget(card);
+                card->deleteLater();
+            }
+            continue;
+        }
 
-        QString title=getWindowTitle(m_dpy,w);
-        if(title.isEmpty()) continue;
-
-        if(title.toLower().contains("osm-running")) continue;
-        if(title.toLower().contains("osm-launcher")) continue;
-        if(title.toLower().contains("wosp-shell")) continue;
-
-        QString cls=getWindowClass(m_dpy,w);
-        titles << title;
+        WindowCard *card = m_cards.value(w);
+        if (!card) {
+            card = new WindowCard(this,m_dpy,info,active);
+            m_cards.insert(w, card);
+            m_thumbs->track(w);
+        } else if (changed.contains(w)) {
+            card->setInfo(info);
+        }
 
-        WindowInfo info{ w,title,cls };
-        WindowCard *card=new WindowCard(this,m_dpy,info,active);
-        m_list->addWidget(card);
+        m_order << w;
+        pids.insert(w, info.pid);
+        titles << info.title;
         count++;
     }
 
-    XFree(data);
+    m_sampler->setWindows(pids);
+    applyOrder();
 
     // compute and apply width
     int needed = computeRequiredWidth(titles);
@@ -389,6 +1386,10 @@ void SidePanel::refreshWindows() {
     resizeToItems(count);
 
     if(count==0 && onClose) onClose();
+
+    // our own requests may have pulled events into Xlib's queue without
+    // the socket becoming readable again; drain them on the next loop pass
+    QTimer::singleShot(0, this, [this](){ handleXEvents(); });
 }
 
 // ───────────────────────────────────────────── WindowCard impl
@@ -410,27 +1411,38 @@ WindowCard::WindowCard(
     lay->setContentsMargins(10,2,10,2);
     lay->setSpacing(2);
 
+    // filled in by the thumbnailer; stays hidden without XComposite/XDamage
+    QLabel *thumb=new QLabel(this);
+    thumb->setFixedSize(WindowThumbnailer::kThumbW, WindowThumbnailer::kThumbH);
+    thumb->setAlignment(Qt::AlignCenter);
+    thumb->setStyleSheet("background:#000000;border-radius:8px;");
+    thumb->hide();
+    m_thumbLabel = thumb;
+
     QLabel *icon=new QLabel(this);
     icon->setFixedSize(32,32);
-
-    QPixmap px=getNetWmIcon(m_dpy,m_info.id,28);
-    if(px.isNull()) {
-        QIcon themed=QIcon::fromTheme(m_info.appClass);
-        if(!themed.isNull()) px=themed.pixmap(64,64);
-    }
-    if(px.isNull()) {
-        px=QPixmap(28,28);
-        px.fill(QColor("#333"));
-    }
-
-    icon->setPixmap(px);
     icon->setScaledContents(true);
+    m_iconLabel = icon;
 
-    QLabel *title = new QLabel(m_info.title, this);
+    QLabel *title = new QLabel(this);
     title->setStyleSheet("color:white;font-size:28px;");
     title->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     m_titleLabel = title;
 
+    // filled in by the ProcessSampler while the panel is open
+    QLabel *usage = new QLabel(this);
+    usage->setStyleSheet("color:#aaaaaa;font-size:18px;");
+    usage->hide();
+    m_usageLabel = usage;
+
+    QVBoxLayout *text = new QVBoxLayout;
+    text->setContentsMargins(0,0,0,0);
+    text->setSpacing(0);
+    text->addWidget(title);
+    text->addWidget(usage);
+
+    setInfo(info);
+
     QPushButton *close=new QPushButton("❌",this);
     close->setFixedSize(48,48);
     close->setStyleSheet(
@@ -440,8 +1452,10 @@ WindowCard::WindowCard(
         "QPushButton:pressed { color:#ffffff; background:#550000; border-radius:18px; }"
     );
 
+    lay->addWidget(thumb);
+    lay->addSpacing(8);
     lay->addWidget(icon);
-    lay->addWidget(title,1);
+    lay->addLayout(text,1);
     lay->addWidget(close);
 
     connect(close,&QPushButton::clicked,[this](){
@@ -449,9 +1463,50 @@ WindowCard::WindowCard(
     });
 }
 
+void WindowCard::setInfo(const WindowInfo &info) {
+    m_info = info;
+
+    QPixmap px=m_info.icon;
+    if(px.isNull()) {
+        QIcon themed=QIcon::fromTheme(m_info.appClass);
+        if(!themed.isNull()) px=themed.pixmap(64,64);
+    }
+    if(px.isNull()) {
+        px=QPixmap(28,28);
+        px.fill(QColor("#333"));
+    }
+
+    m_iconLabel->setPixmap(px);
+    m_titleLabel->setText(m_info.title);
+}
+
+void WindowCard::setThumbnail(const QPixmap &px) {
+    m_thumbLabel->setPixmap(px);
+    m_thumbLabel->show();
+}
+
+void WindowCard::setUsage(const ProcUsage &u) {
+    if (!u.valid) {
+        m_usageLabel->hide();
+        return;
+    }
+
+    qint64 kb = u.pssKb > 0 ? u.pssKb : u.rssKb;
+    QString mem = kb >= 1024 * 1024
+        ? QString::number(kb / (1024.0 * 1024.0), 'f', 1) + " GB"
+        : QString::number(kb / 1024) + " MB";
+
+    m_usageLabel->setText(QString("CPU %1%  ·  %2 %3")
+                          .arg(u.cpu, 0, 'f', u.cpu < 10 ? 1 : 0)
+                          .arg(mem)
+                          .arg(u.pssKb > 0 ? "PSS" : "RSS"));
+    m_usageLabel->show();
+}
+
 void WindowCard::mousePressEvent(QMouseEvent *e) {
     if(e->button()==Qt::LeftButton) {
-        if (m_titleLabel && m_titleLabel->geometry().contains(e->pos())) {
+        if ((m_titleLabel && m_titleLabel->geometry().contains(e->pos())) ||
+            (m_thumbLabel->isVisible() && m_thumbLabel->geometry().contains(e->pos()))) {
             m_panel->handleEntryActivateAndClose(m_info.id);
             return;
         }
@@ -497,6 +1552,9 @@ public:
 
     void showPanel() {
         if (m_panelVisible) return;
+
+        // list is only kept current while shown; catch up before sizing
+        m_panel->refreshIfDirty();
         m_panelVisible = true;
 
         setGeometry(m_screenGeo);
@@ -538,6 +1596,8 @@ public:
         anim->start(QAbstractAnimation::DeleteWhenStopped);
     }
 
+    QWidget *panel() const { return m_panel; }
+
 protected:
     void mousePressEvent(QMouseEvent *e) override {
         if (m_panel && !m_panel->geometry().contains(e->pos()))
@@ -553,84 +1613,6 @@ private:
     Display *m_dpy;
 };
 
-// ───────────────────────────────────────────── ActivationEdgeBar
-// Always-on-top, left-side touch bar. Periodically re-raises itself.
-
-class ActivationEdgeBar : public QWidget {
-public:
-    explicit ActivationEdgeBar(OverlayRoot *overlay, QWidget *parent = nullptr)
-        : QWidget(parent),
-          m_overlay(overlay),
-          m_dragging(false)
-    {
-        setWindowFlags(Qt::FramelessWindowHint
-                       | Qt::WindowStaysOnTopHint
-                       | Qt::BypassWindowManagerHint
-                       | Qt::WindowDoesNotAcceptFocus);
-        setAttribute(Qt::WA_TranslucentBackground);
-        setAttribute(Qt::WA_NoSystemBackground);
-        setAttribute(Qt::WA_ShowWithoutActivating);
-        setMouseTracking(true);
-
-        QRect g = QGuiApplication::primaryScreen()->geometry();
-        setGeometry(g.x(), g.y(), 25, g.height());
-        setStyleSheet("background: rgba(0,0,0,0);");
-
-        show();
-        raise();
-
-        // Keep stubbornly on top, like a real gesture edge.
-        m_raiseTimer = new QTimer(this);
-        m_raiseTimer->setInterval(1500);   // 1.5s is usually enough
-        connect(m_raiseTimer, &QTimer::timeout, this, [this]() {
-            this->raise();
-        });
-        m_raiseTimer->start();
-    }
-
-protected:
-    void mousePressEvent(QMouseEvent *e) override {
-        if (e->button() == Qt::LeftButton) {
-            m_dragging = true;
-            m_pressPos = e->globalPos();
-            raise();  // assert on top when touched
-        }
-        QWidget::mousePressEvent(e);
-    }
-
-    void mouseMoveEvent(QMouseEvent *e) override {
-        if (!m_dragging) {
-            QWidget::mouseMoveEvent(e);
-            return;
-        }
-
-        int dx = e->globalX() - m_pressPos.x();
-        if (dx > 12) {  // slide-right threshold
-            if (m_overlay) {
-                m_overlay->showPanel();
-            }
-            m_dragging = false;
-        }
-
-        QWidget::mouseMoveEvent(e);
-    }
-
-    void mouseReleaseEvent(QMouseEvent *e) override {
-        m_dragging = false;
-        QWidget::mouseReleaseEvent(e);
-    }
-
-    void paintEvent(QPaintEvent *) override {
-        // fully invisible
-    }
-
-private:
-    OverlayRoot *m_overlay;
-    bool m_dragging;
-    QPoint m_pressPos;
-    QTimer *m_raiseTimer;
-};
-
 // ───────────────────────────────────────────── main
 
 int main(int argc,char**argv) {
@@ -643,9 +1625,11 @@ int main(int argc,char**argv) {
 
     Display *dpy=XOpenDisplay(nullptr);
     if(!dpy) return 1;
+    XSetErrorHandler(ignoreXErrors);
+    internAtoms(dpy);
 
     OverlayRoot root(dpy);          // overlay window
-    ActivationEdgeBar bar(&root);   // always-on-top gesture edge
+    EdgeListener edge("osm-running", root.panel(), [&root]() { root.showPanel(); });
 
     int r=app.exec();
     XCloseDisplay(dpy);
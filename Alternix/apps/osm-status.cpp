@@ -8,7 +8,6 @@
 #include <QPushButton>
 #include <QScreen>
 #include <QTimer>
-#include <QGraphicsDropShadowEffect>
 #include <QMouseEvent>
 #include <QLockFile>
 #include <QDir>
@@ -21,18 +20,394 @@
 #include <QDateTime>
 #include <QTextStream>
 #include <QPainter>
+#include <QStandardPaths>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QEvent>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QSaveFile>
+#include <QRegularExpression>
 
 #include <functional>
+#include <algorithm>
+#include <vector>
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common/fdnotifier.h"
+#include "common/edgelistener.h"
+#include "common/panelshadow.h"
 
 // ───────────────────────────────────────────── Structures
 
 struct NotificationInfo {
+    quint32 id = 0;        // log record id
+    QString app;
     QString title;
     QString body;
-    QString path;
     QDateTime when;
 };
 
+// Live notifications with the same app and title share one card. Repeats
+// bump the counter; only distinct bodies are kept for display.
+struct NotificationGroup {
+    QString          app;
+    QString          title;
+    QDateTime        when;          // newest
+    QVector<quint32> ids;           // live log ids, oldest first
+    QStringList      bodies;        // newest distinct bodies, at most 3
+    QSet<QString>    seenBodies;
+    int              titleWidth;
+};
+
+// one log record as kept in memory; title and body stay on disk
+struct LogEntry {
+    qint64  offset;
+    qint64  when;          // epoch ms
+    quint32 id;
+    quint32 length;        // record bytes, newline excluded
+    quint16 app;           // index into NotificationLog::m_apps
+    bool    dismissed;
+};
+
+// ───────────────────────────────────────────── NotificationLog
+// Every notification lives in ~/.osm-notify/notifications.log, one record
+// per line, only ever appended to:
+//
+//   N <id> <epoch-ms> <app>\t<title>\t<body>    live
+//   H <id> <epoch-ms> <app>\t<title>\t<body>    dismissed (after compaction)
+//   X <id>                                      dismissal tombstone
+//
+// Startup maps the file once and indexes record headers only. Titles and
+// bodies are pread back when a card or history page needs them.
+
+static const int LOG_MAX_ENTRIES       = 20000;  // history kept by compaction
+static const int LOG_COMPACT_TOMBSTONES = 256;
+
+class NotificationLog {
+public:
+    NotificationLog() : m_fd(-1), m_nextId(1), m_tombstones(0), m_dismissed(0) {}
+    ~NotificationLog() { if (m_fd >= 0) ::close(m_fd); }
+
+    bool open(const QString &path);
+    bool append(NotificationInfo &info);        // assigns info.id
+    bool dismiss(quint32 id);
+    bool read(const LogEntry &e, NotificationInfo &info) const;
+
+    bool needsCompaction() const {
+        return m_tombstones >= LOG_COMPACT_TOMBSTONES ||
+               m_entries.size() > LOG_MAX_ENTRIES + LOG_MAX_ENTRIES / 10;
+    }
+    bool compact();
+
+    // oldest first
+    const QVector<LogEntry> &entries() const { return m_entries; }
+    int dismissedCount() const { return m_dismissed; }
+
+private:
+    bool load();
+    void indexRecord(const char *p, qint64 offset, qint64 len);
+    quint16 internApp(const QString &app);
+
+    QString                  m_path;
+    int                      m_fd;
+    quint32                  m_nextId;
+    int                      m_tombstones;
+    int                      m_dismissed;
+    QVector<LogEntry>        m_entries;
+    QHash<quint32, int>      m_byId;      // id → m_entries index
+    QStringList              m_apps;
+    QHash<QString, quint16>  m_appIds;
+};
+
+static QByteArray escapeField(const QString &s) {
+    QByteArray in = s.toUtf8();
+    QByteArray out;
+    out.reserve(in.size());
+    for (char c : in) {
+        if (c == '\\')      out += "\\\\";
+        else if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else                out += c;
+    }
+    return out;
+}
+
+static QString unescapeField(const QByteArray &in) {
+    QByteArray out;
+    out.reserve(in.size());
+    for (int i = 0; i < in.size(); ++i) {
+        char c = in[i];
+        if (c == '\\' && i + 1 < in.size()) {
+            char n = in[++i];
+            out += n == 't' ? '\t' : n == 'n' ? '\n' : n;
+        } else {
+            out += c;
+        }
+    }
+    return QString::fromUtf8(out);
+}
+
+// "N 12 1718000000000 app\t..." or "X 12"; false if malformed
+static bool parseRecordHeader(const QByteArray &line, char &kind, quint32 &id,
+                              qint64 &when, QByteArray &app)
+{
+    if (line.size() < 3 || line[1] != ' ') return false;
+    kind = line[0];
+
+    bool ok = false;
+    int sp2 = line.indexOf(' ', 2);
+    if (kind == 'X') {
+        id = line.mid(2).toUInt(&ok);
+        return ok;
+    }
+    if (kind != 'N' && kind != 'H') return false;
+    if (sp2 < 0) return false;
+
+    int sp3 = line.indexOf(' ', sp2 + 1);
+    int tab = line.indexOf('\t', sp3 + 1);
+    if (sp3 < 0 || tab < 0) return false;
+
+    id = line.mid(2, sp2 - 2).toUInt(&ok);
+    if (!ok) return false;
+    when = line.mid(sp2 + 1, sp3 - sp2 - 1).toLongLong(&ok);
+    if (!ok) return false;
+    app = line.mid(sp3 + 1, tab - sp3 - 1);
+    return true;
+}
+
+bool NotificationLog::open(const QString &path) {
+    m_path = path;
+    m_fd = ::open(QFile::encodeName(path).constData(),
+                  O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (m_fd < 0) {
+        qWarning() << "open" << path << strerror(errno);
+        return false;
+    }
+    return load();
+}
+
+bool NotificationLog::load() {
+    struct stat st;
+    if (fstat(m_fd, &st) < 0) return false;
+    qint64 size = st.st_size;
+    if (size == 0) return true;
+
+    void *map = mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (map == MAP_FAILED) {
+        qWarning() << "mmap" << m_path << strerror(errno);
+        return false;
+    }
+
+    const char *data = static_cast<const char *>(map);
+    qint64 pos = 0;
+    while (pos < size) {
+        const char *nl = static_cast<const char *>(memchr(data + pos, '\n', size_t(size - pos)));
+        if (!nl) break;
+        qint64 len = nl - (data + pos);
+        indexRecord(data + pos, pos, len);
+        pos += len + 1;
+    }
+    munmap(map, size_t(size));
+
+    // a crash mid-append leaves half a record; cut it so the next one is clean
+    if (pos < size) {
+        qWarning() << "dropping torn record at end of" << m_path;
+        if (ftruncate(m_fd, pos) < 0)
+            qWarning() << "ftruncate" << m_path << strerror(errno);
+    }
+    return true;
+}
+
+void NotificationLog::indexRecord(const char *p, qint64 offset, qint64 len) {
+    char kind;
+    quint32 id;
+    qint64 when = 0;
+    QByteArray app;
+    if (!parseRecordHeader(QByteArray::fromRawData(p, int(len)), kind, id, when, app))
+        return;
+
+    if (kind == 'X') {
+        ++m_tombstones;
+        auto it = m_byId.constFind(id);
+        if (it != m_byId.constEnd() && !m_entries[*it].dismissed) {
+            m_entries[*it].dismissed = true;
+            ++m_dismissed;
+        }
+        return;
+    }
+
+    LogEntry e;
+    e.offset    = offset;
+    e.when      = when;
+    e.id        = id;
+    e.length    = quint32(len);
+    e.app       = internApp(QString::fromUtf8(app));
+    e.dismissed = (kind == 'H');
+    if (e.dismissed) ++m_dismissed;
+
+    m_byId.insert(id, m_entries.size());
+    m_entries.append(e);
+    m_nextId = qMax(m_nextId, id + 1);
+}
+
+quint16 NotificationLog::internApp(const QString &app) {
+    auto it = m_appIds.constFind(app);
+    if (it != m_appIds.constEnd()) return *it;
+    if (m_apps.size() >= 0xffff) return 0;
+    quint16 idx = quint16(m_apps.size());
+    m_apps.append(app);
+    m_appIds.insert(app, idx);
+    return idx;
+}
+
+bool NotificationLog::append(NotificationInfo &info) {
+    if (m_fd < 0) return false;
+
+    quint32 id = m_nextId;
+    qint64 when = info.when.toMSecsSinceEpoch();
+    QByteArray rec = "N " + QByteArray::number(id) + ' ' + QByteArray::number(when) + ' ' +
+                     escapeField(info.app) + '\t' +
+                     escapeField(info.title) + '\t' +
+                     escapeField(info.body);
+
+    // single writer (osm-status holds the lock), so the end is ours
+    off_t offset = lseek(m_fd, 0, SEEK_END);
+    QByteArray line = rec + '\n';
+    if (offset < 0 || ::write(m_fd, line.constData(), size_t(line.size())) != line.size()) {
+        qWarning() << "append to" << m_path << strerror(errno);
+        if (offset >= 0 && ftruncate(m_fd, offset) < 0)
+            qWarning() << "ftruncate" << m_path << strerror(errno);
+        return false;
+    }
+
+    LogEntry e;
+    e.offset    = offset;
+    e.when      = when;
+    e.id        = id;
+    e.length    = quint32(rec.size());
+    e.app       = internApp(info.app);
+    e.dismissed = false;
+
+    m_byId.insert(id, m_entries.size());
+    m_entries.append(e);
+    m_nextId = id + 1;
+
+    info.id = id;
+    return true;
+}
+
+bool NotificationLog::dismiss(quint32 id) {
+    auto it = m_byId.constFind(id);
+    if (it == m_byId.constEnd() || m_entries[*it].dismissed)
+        return false;
+
+    QByteArray line = "X " + QByteArray::number(id) + '\n';
+    if (::write(m_fd, line.constData(), size_t(line.size())) != line.size()) {
+        qWarning() << "tombstone to" << m_path << strerror(errno);
+        return false;
+    }
+
+    m_entries[*it].dismissed = true;
+    ++m_dismissed;
+    ++m_tombstones;
+    return true;
+}
+
+bool NotificationLog::read(const LogEntry &e, NotificationInfo &info) const {
+    QByteArray buf(int(e.length), Qt::Uninitialized);
+    if (pread(m_fd, buf.data(), e.length, e.offset) != qint64(e.length))
+        return false;
+
+    int t1 = buf.indexOf('\t');
+    int t2 = t1 < 0 ? -1 : buf.indexOf('\t', t1 + 1);
+    if (t2 < 0) return false;
+
+    info.id    = e.id;
+    info.app   = m_apps.value(e.app);
+    info.title = unescapeField(buf.mid(t1 + 1, t2 - t1 - 1));
+    info.body  = unescapeField(buf.mid(t2 + 1));
+    info.when  = QDateTime::fromMSecsSinceEpoch(e.when);
+    return true;
+}
+
+// Rewrite the log without tombstones: dismissed records become 'H', and
+// the oldest history beyond LOG_MAX_ENTRIES is dropped. Live records are
+// always kept. The new file replaces the old one atomically.
+bool NotificationLog::compact() {
+    if (m_fd < 0) return false;
+
+    int drop = qMax(0, m_entries.size() - LOG_MAX_ENTRIES);
+
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "compact" << m_path << out.errorString();
+        return false;
+    }
+
+    QVector<LogEntry> kept;
+    kept.reserve(m_entries.size() - drop);
+    qint64 pos = 0;
+    QByteArray buf;
+
+    for (const LogEntry &e : m_entries) {
+        if (drop > 0 && e.dismissed) {
+            --drop;
+            continue;
+        }
+
+        buf.resize(int(e.length));
+        if (pread(m_fd, buf.data(), e.length, e.offset) != qint64(e.length)) {
+            out.cancelWriting();
+            return false;
+        }
+        if (e.dismissed) buf[0] = 'H';
+        buf += '\n';
+        if (out.write(buf) != buf.size()) {
+            out.cancelWriting();
+            return false;
+        }
+
+        LogEntry k = e;
+        k.offset = pos;
+        kept.append(k);
+        pos += buf.size();
+    }
+
+    if (!out.commit()) {
+        qWarning() << "compact" << m_path << out.errorString();
+        return false;
+    }
+
+    // old fd now points at the replaced inode
+    int fd = ::open(QFile::encodeName(m_path).constData(), O_RDWR | O_APPEND | O_CLOEXEC);
+    if (fd < 0)
+        qWarning() << "reopen" << m_path << strerror(errno);
+    ::close(m_fd);
+    m_fd = fd;
+
+    m_entries = kept;
+    m_byId.clear();
+    m_dismissed = 0;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        m_byId.insert(m_entries[i].id, i);
+        if (m_entries[i].dismissed) ++m_dismissed;
+    }
+    m_tombstones = 0;
+    return true;
+}
+
 class StatusPanel;
 class NotificationCard;
 class OverlayRoot;         // forward
@@ -45,18 +420,14 @@ public:
     explicit StatusPanel(QWidget *parent=nullptr);
 
     void refreshNotifications();
-    void removeNotification(const QString &path);
+    void removeGroup(const QString &key);
     void resizeToItems(int count);
+    void setHistoryVisible(bool on);
 
-    // overlay width from edge of screen
-    int computeRequiredWidth(const QStringList &titles) {
-        int base = 360;
+    // title width at card font; the overlay grows to fit the widest
+    static int titleAdvance(const QString &title) {
         QFont f; f.setPointSize(32);
-        QFontMetrics fm(f);
-        int max = 0;
-        for (const QString &t : titles)
-            max = qMax(max, fm.horizontalAdvance(t));
-        return base + max;
+        return QFontMetrics(f).horizontalAdvance(title);
     }
 
     void setCloseCallback(std::function<void()> fn) { onClose = fn; }
@@ -67,7 +438,27 @@ public:
     std::function<void()>    onClose;
     std::function<void(int)> onCountChanged;
 
+protected:
+    // shadow (same as osm-running), painted behind m_inner
+    void paintEvent(QPaintEvent *e) override {
+        Q_UNUSED(e);
+        static const int radii[4] = { 26, 0, 0, 26 };
+        QPainter p(this);
+        PanelShadow::paintPanel(p, m_inner->geometry(), radii);
+    }
+
 private:
+    void readInbox();
+    bool importFile(const QString &path);
+    void addToGroup(const NotificationInfo &info);
+    void scheduleFlush();
+    void flushGroups();
+    void dropCard(const QString &key);
+    void placeCard(NotificationCard *card);
+    void applyLayout();
+    void showHistoryPage(int page);
+    QWidget *historyRow(const NotificationInfo &info);
+
     QWidget     *m_inner;
     QWidget     *m_content;
     QVBoxLayout *m_list;
@@ -75,21 +466,56 @@ private:
     int          m_maxH;
     QString      m_dirPath;
     int          m_notificationCount;
+
+    // ~/.osm-notify is watched, not polled; .txt files dropped there are
+    // moved into the log and deleted
+    int                                  m_inotifyFd;
+    NotificationLog                      m_log;
+    QTimer                              *m_compactTimer;
+
+    // keyed by app + '\x1f' + title. Groups change as files arrive; cards
+    // catch up once per frame (m_flush) however many arrived meanwhile.
+    QHash<QString, NotificationGroup>    m_groups;
+    QHash<QString, NotificationCard*>    m_cards;
+    QSet<QString>                        m_dirtyGroups;
+    QTimer                              *m_flush;
+    int                                  m_maxTitleWidth;
+
+    // dismissed notifications, one page of rows at a time
+    QWidget     *m_footer;
+    QWidget     *m_history;
+    QVBoxLayout *m_historyList;
+    QLabel      *m_historyPos;
+    QPushButton *m_historyBtn;
+    QPushButton *m_newerBtn;
+    QPushButton *m_olderBtn;
+    int          m_historyPage;
+    bool         m_showHistory;
 };
 
+static const int HISTORY_PAGE = 10;   // rows per history page
+
 // ───────────────────────────────────────────── NotificationCard
 
 class NotificationCard : public QFrame {
 public:
-    NotificationCard(StatusPanel *panel, const NotificationInfo &info, QWidget *parent=nullptr);
+    NotificationCard(StatusPanel *panel, const QString &key, QWidget *parent=nullptr);
+
+    // relabel in place; the card is reused as its group grows
+    void setGroup(const NotificationGroup &g);
+    const QDateTime &when() const { return m_when; }
 
 protected:
     void mousePressEvent(QMouseEvent *e) override;
 
 private:
     StatusPanel      *m_panel;
-    NotificationInfo  m_info;
+    QString           m_key;
+    QDateTime         m_when;
+    QLabel           *m_timeLabel;
     QLabel           *m_titleLabel;
+    QLabel           *m_countLabel;
+    QLabel           *m_bodyLabel;
 };
 
 // ───────────────────────────────────────────── NotificationBadge
@@ -121,7 +547,20 @@ StatusPanel::StatusPanel(QWidget *parent)
       m_width(0),
       m_maxH(0),
       m_dirPath(),
-      m_notificationCount(0)
+      m_notificationCount(0),
+      m_inotifyFd(-1),
+      m_compactTimer(nullptr),
+      m_flush(nullptr),
+      m_maxTitleWidth(0),
+      m_footer(nullptr),
+      m_history(nullptr),
+      m_historyList(nullptr),
+      m_historyPos(nullptr),
+      m_historyBtn(nullptr),
+      m_newerBtn(nullptr),
+      m_olderBtn(nullptr),
+      m_historyPage(0),
+      m_showHistory(false)
 {
     setWindowFlag(Qt::WindowDoesNotAcceptFocus,true);
     setFocusPolicy(Qt::NoFocus);
@@ -154,6 +593,7 @@ StatusPanel::StatusPanel(QWidget *parent)
 
     QVBoxLayout *inner = new QVBoxLayout(m_inner);
     inner->setContentsMargins(16, 16, 16, 16);
+    inner->setSpacing(10);
 
     m_content = new QWidget;
     m_content->setStyleSheet("background:#00000099; border-radius:14px;");
@@ -165,24 +605,92 @@ StatusPanel::StatusPanel(QWidget *parent)
     m_list->setContentsMargins(10, 5, 5, 15);
 
     inner->addWidget(m_content);
-    outer->addWidget(m_inner);
 
-    // shadow (same as osm-running)
-    QGraphicsDropShadowEffect *sh = new QGraphicsDropShadowEffect(this);
-    sh->setBlurRadius(32);
-    sh->setOffset(0, 0);
-    sh->setColor(QColor(0, 0, 0, 220));
-    m_inner->setGraphicsEffect(sh);
+    m_history = new QWidget;
+    m_history->setStyleSheet("background:#00000099; border-radius:14px;");
+    m_history->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
+    m_historyList = new QVBoxLayout(m_history);
+    m_historyList->setSpacing(8);
+    m_historyList->setContentsMargins(10, 5, 5, 15);
+    m_history->hide();
+    inner->addWidget(m_history);
+
+    // footer: history toggle, plus paging while history is shown
+    const char *btnStyle =
+        "QPushButton { color:white; font-size:22px; background:#282828;"
+        " border-radius:14px; padding:6px 14px; }"
+        "QPushButton:pressed { background:#550000; }"
+        "QPushButton:disabled { color:#666666; }";
+
+    m_footer = new QWidget;
+    QHBoxLayout *footer = new QHBoxLayout(m_footer);
+    footer->setContentsMargins(0, 0, 0, 0);
+    footer->setSpacing(10);
+
+    m_newerBtn = new QPushButton("‹", m_footer);
+    m_olderBtn = new QPushButton("›", m_footer);
+    m_historyPos = new QLabel(m_footer);
+    m_historyPos->setStyleSheet("color:#BBBBBB;font-size:20px;");
+    m_historyBtn = new QPushButton("History", m_footer);
+    for (QPushButton *b : {m_newerBtn, m_olderBtn, m_historyBtn})
+        b->setStyleSheet(btnStyle);
+
+    footer->addWidget(m_newerBtn);
+    footer->addWidget(m_historyPos);
+    footer->addWidget(m_olderBtn);
+    footer->addStretch(1);
+    footer->addWidget(m_historyBtn);
+    m_newerBtn->hide();
+    m_olderBtn->hide();
+    m_historyPos->hide();
+    inner->addWidget(m_footer);
+
+    connect(m_historyBtn, &QPushButton::clicked, [this]() { setHistoryVisible(!m_showHistory); });
+    connect(m_newerBtn, &QPushButton::clicked, [this]() { showHistoryPage(m_historyPage - 1); });
+    connect(m_olderBtn, &QPushButton::clicked, [this]() { showHistoryPage(m_historyPage + 1); });
+
+    outer->addWidget(m_inner);
 
     // notifications folder
     m_dirPath = QDir::homePath() + "/.osm-notify";
     QDir d(m_dirPath);
     if (!d.exists()) d.mkpath(".");
 
-    QTimer *t = new QTimer(this);
-    t->setInterval(600);
-    connect(t, &QTimer::timeout, [this](){ refreshNotifications(); });
-    t->start();
+    m_log.open(m_dirPath + "/notifications.log");
+    if (m_log.needsCompaction())
+        m_log.compact();
+
+    m_flush = new QTimer(this);
+    m_flush->setSingleShot(true);
+    connect(m_flush, &QTimer::timeout, [this]() { flushGroups(); });
+
+    for (const LogEntry &e : m_log.entries()) {
+        NotificationInfo info;
+        if (!e.dismissed && m_log.read(e, info))
+            addToGroup(info);
+    }
+
+    // tombstones pile up as cards are dismissed; fold them in while idle
+    m_compactTimer = new QTimer(this);
+    m_compactTimer->setSingleShot(true);
+    m_compactTimer->setInterval(30000);
+    connect(m_compactTimer, &QTimer::timeout, [this]() {
+        if (m_log.needsCompaction())
+            m_log.compact();
+    });
+
+    // finished and renamed-in files; nothing else wakes us
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        QByteArray dirPath = QFile::encodeName(m_dirPath);
+        if (inotify_add_watch(m_inotifyFd, dirPath.constData(),
+                              IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            qWarning() << "inotify_add_watch" << m_dirPath << strerror(errno);
+        }
+        new FdNotifier(m_inotifyFd, [this]() { readInbox(); }, this);
+    } else {
+        qWarning() << "inotify_init1 failed:" << strerror(errno);
+    }
 
     refreshNotifications();
 }
@@ -192,11 +700,12 @@ void StatusPanel::resizeToItems(int count) {
     Q_UNUSED(count);
 
     int totalH = 0;
+    QVBoxLayout *list = m_showHistory ? m_historyList : m_list;
 
-    if (m_list) {
-        int itemCount = m_list->count();
+    if (list) {
+        int itemCount = list->count();
         for (int i = 0; i < itemCount; ++i) {
-            QLayoutItem *it = m_list->itemAt(i);
+            QLayoutItem *it = list->itemAt(i);
             if (!it) continue;
             QWidget *w = it->widget();
             if (!w) continue;
@@ -204,12 +713,16 @@ void StatusPanel::resizeToItems(int count) {
         }
 
         if (itemCount > 1)
-            totalH += (itemCount - 1) * m_list->spacing();
+            totalH += (itemCount - 1) * list->spacing();
 
-        QMargins lm = m_list->contentsMargins();
+        QMargins lm = list->contentsMargins();
         totalH += lm.top() + lm.bottom();
     }
 
+    // footer row plus the inner layout spacing above it
+    if (m_footer)
+        totalH += m_footer->sizeHint().height() + 10;
+
     // inner + outer margins overhead (approx), similar to osm-running
     int h = totalH + 40;
     h = qBound(120, h, m_maxH);
@@ -220,90 +733,219 @@ void StatusPanel::resizeToItems(int count) {
     setGeometry(screenGeo.width() - m_width, top, m_width, h);
 }
 
-void StatusPanel::refreshNotifications() {
-    // clear list
-    QLayoutItem *it;
-    while((it = m_list->takeAt(0))) {
-        if(it->widget()) it->widget()->deleteLater();
-        delete it;
+static bool parseNotificationFile(const QFileInfo &fi, NotificationInfo &info) {
+    QFile f(fi.absoluteFilePath());
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream in(&f);
+    QString contents = in.readAll();
+
+    QStringList lines = contents.split('\n');
+    for (QString &ln : lines)
+        ln = ln.trimmed();
+
+    QString rawTitle;
+    QString body;
+
+    int firstNonEmpty = -1;
+    for (int i = 0; i < lines.size(); ++i) {
+        if (!lines[i].isEmpty()) {
+            firstNonEmpty = i;
+            break;
+        }
     }
 
-    QDir dir(m_dirPath);
-    dir.setNameFilters(QStringList() << "*.txt");
+    if (firstNonEmpty >= 0) {
+        rawTitle = lines[firstNonEmpty];
+        QStringList rest;
+        for (int i = firstNonEmpty + 1; i < lines.size(); ++i)
+            rest << lines[i];
+        body = rest.join('\n').trimmed();
+    }
 
-    QFileInfoList files = dir.entryInfoList(
-        QDir::Files | QDir::Readable,
-        QDir::Time | QDir::Reversed    // oldest first
-    );
+    QString title = rawTitle;
+    if (title.isEmpty()) {
+        QString base = fi.completeBaseName();
+        if (!base.isEmpty())
+            title = base;
+        else
+            title = "(REDACTED)";
+        body = contents.trimmed();
+    }
 
-    // newest first
-    std::reverse(files.begin(), files.end());
+    // files carry no app field; the name minus a trailing counter or
+    // timestamp is the closest thing to one
+    QString app = fi.completeBaseName();
+    app.remove(QRegularExpression("[-_.]?\\d+$"));
 
-    QStringList titles;
-    int count = 0;
+    info.app   = app;
+    info.title = title;
+    info.body  = body;
+    info.when  = fi.lastModified();
+    return true;
+}
 
-    for (const QFileInfo &fi : files) {
-        QFile f(fi.absoluteFilePath());
-        if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-            continue;
+// Import every .txt waiting in the inbox: used at startup and if the
+// inotify queue overflowed.
+void StatusPanel::refreshNotifications() {
+    QDir dir(m_dirPath);
+    dir.setNameFilters(QStringList() << "*.txt");
 
-        QTextStream in(&f);
-        QString contents = in.readAll();
+    QFileInfoList files = dir.entryInfoList(QDir::Files | QDir::Readable, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &fi : files)
+        importFile(fi.absoluteFilePath());
 
-        QStringList lines = contents.split('\n');
-        for (QString &ln : lines)
-            ln = ln.trimmed();
+    flushGroups();
+}
+
+void StatusPanel::readInbox() {
+    alignas(struct inotify_event) char buf[4096];
+    bool overflow = false;
 
-        QString rawTitle;
-        QString body;
+    ssize_t n;
+    while ((n = ::read(m_inotifyFd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
 
-        int firstNonEmpty = -1;
-        for (int i = 0; i < lines.size(); ++i) {
-            if (!lines[i].isEmpty()) {
-                firstNonEmpty = i;
-                break;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
             }
+            if (!ev->len) continue;
+
+            QString name = QFile::decodeName(ev->name);
+            if (!name.endsWith(".txt")) continue;
+            QString path = m_dirPath + "/" + name;
+
+            importFile(path);
         }
+    }
 
-        if (firstNonEmpty >= 0) {
-            rawTitle = lines[firstNonEmpty];
-            QStringList rest;
-            for (int i = firstNonEmpty + 1; i < lines.size(); ++i)
-                rest << lines[i];
-            body = rest.join('\n').trimmed();
-        } else {
-            rawTitle.clear();
-            body.clear();
+    if (overflow)
+        refreshNotifications();
+}
+
+// Drop-in importer for producers that still write one .txt per
+// notification: append it to the log, then delete the file.
+bool StatusPanel::importFile(const QString &path) {
+    NotificationInfo info;
+    if (!parseNotificationFile(QFileInfo(path), info))
+        return false;
+
+    // leave the file in place if the log can't take it; the next rescan retries
+    if (!m_log.append(info))
+        return false;
+
+    QFile::remove(path);
+    addToGroup(info);
+    return true;
+}
+
+static QString groupKey(const QString &app, const QString &title) {
+    return app + QChar(0x1f) + title;
+}
+
+void StatusPanel::addToGroup(const NotificationInfo &info) {
+    QString key = groupKey(info.app, info.title);
+
+    auto it = m_groups.find(key);
+    if (it == m_groups.end()) {
+        NotificationGroup g;
+        g.app = info.app;
+        g.title = info.title;
+        g.when = info.when;
+        g.titleWidth = titleAdvance(info.title);
+        m_maxTitleWidth = qMax(m_maxTitleWidth, g.titleWidth);
+        it = m_groups.insert(key, g);
+    }
+
+    NotificationGroup &g = *it;
+    g.ids.append(info.id);
+    if (info.when > g.when) g.when = info.when;
+
+    // identical bodies collapse into the counter
+    if (!info.body.isEmpty() && !g.seenBodies.contains(info.body)) {
+        g.seenBodies.insert(info.body);
+        g.bodies.prepend(info.body);
+        if (g.bodies.size() > 3) g.bodies.removeLast();
+    }
+
+    m_dirtyGroups.insert(key);
+    scheduleFlush();
+}
+
+// One layout pass per frame while the panel is up; while it is hidden
+// nothing is painted, so a burst only needs to land for the badge.
+void StatusPanel::scheduleFlush() {
+    if (m_flush->isActive()) return;
+    m_flush->start(isVisible() ? 16 : 250);
+}
+
+void StatusPanel::flushGroups() {
+    m_flush->stop();
+    if (m_dirtyGroups.isEmpty()) {
+        applyLayout();
+        return;
+    }
+
+    for (const QString &key : m_dirtyGroups) {
+        auto it = m_groups.constFind(key);
+        if (it == m_groups.constEnd()) {
+            dropCard(key);
+            continue;
         }
 
-        QString title = rawTitle;
-        if (title.isEmpty()) {
-            QString base = fi.completeBaseName();
-            if (!base.isEmpty())
-                title = base;
-            else
-                title = "(REDACTED)";
-            body = contents.trimmed();
+        NotificationCard *card = m_cards.value(key);
+        if (!card) {
+            card = new NotificationCard(this, key, m_content);
+            m_cards.insert(key, card);
         }
+        card->setGroup(*it);
+        placeCard(card);
+    }
+    m_dirtyGroups.clear();
 
-        NotificationInfo info;
-        info.title = title;
-        info.body  = body;
-        info.path  = fi.absoluteFilePath();
-        info.when  = fi.lastModified();
+    applyLayout();
+}
+
+void StatusPanel::dropCard(const QString &key) {
+    if (NotificationCard *card = m_cards.take(key)) {
+        m_list->removeWidget(card);
+        card->hide();
+        card->deleteLater();
+    }
+}
 
-        titles << title;
+// newest first, same order the old full rebuild produced
+void StatusPanel::placeCard(NotificationCard *card) {
+    int from = m_list->indexOf(card);
 
-        NotificationCard *card = new NotificationCard(this, info, m_content);
-        m_list->addWidget(card);
-        count++;
+    int idx = 0;
+    for (; idx < m_list->count(); ++idx) {
+        auto *other = dynamic_cast<NotificationCard*>(m_list->itemAt(idx)->widget());
+        if (other && other != card && other->when() < card->when())
+            break;
     }
 
-    m_notificationCount = count;
+    if (from >= 0) {
+        if (from < idx) --idx;
+        if (from == idx) return;
+        m_list->removeWidget(card);
+    }
+    m_list->insertWidget(idx, card);
+}
 
-    // compute and apply width (same logic as osm-running)
-    int needed = computeRequiredWidth(titles);
-    m_width = qMin(needed, 1080);
+void StatusPanel::applyLayout() {
+    int count = m_cards.size();
+    m_notificationCount = 0;
+    for (const NotificationGroup &g : m_groups)
+        m_notificationCount += g.ids.size();
+
+    // compute and apply width (same logic as osm-running); titles are
+    // measured once per group, and the max only shrinks on dismissal
+    m_width = qMin(360 + m_maxTitleWidth, 1080);
 
     QRect g = geometry();
     int x = QGuiApplication::primaryScreen()->geometry().width() - m_width;
@@ -316,22 +958,138 @@ void StatusPanel::refreshNotifications() {
         onCountChanged(m_notificationCount);
 
     // auto-close when empty, same behaviour as SidePanel’s onClose
-    if (count == 0 && onClose)
+    // (but not while the user is reading history)
+    if (count == 0 && !m_showHistory && onClose)
         onClose();
 }
 
-void StatusPanel::removeNotification(const QString &path) {
-    QFile::remove(path);
-    refreshNotifications();
+// Dismissing a card tombstones every notification in its group; the
+// records stay in history.
+void StatusPanel::removeGroup(const QString &key) {
+    auto it = m_groups.find(key);
+    if (it == m_groups.end()) return;
+
+    for (quint32 id : it->ids)
+        m_log.dismiss(id);
+    m_groups.erase(it);
+    m_dirtyGroups.remove(key);
+    dropCard(key);
+
+    m_maxTitleWidth = 0;
+    for (const NotificationGroup &g : m_groups)
+        m_maxTitleWidth = qMax(m_maxTitleWidth, g.titleWidth);
+
+    // the user's own tap: no reason to wait for a frame
+    flushGroups();
+
+    if (m_showHistory)
+        showHistoryPage(m_historyPage);
+
+    if (m_log.needsCompaction())
+        m_compactTimer->start();
+}
+
+void StatusPanel::setHistoryVisible(bool on) {
+    if (m_showHistory == on) return;
+    m_showHistory = on;
+
+    m_content->setVisible(!on);
+    m_history->setVisible(on);
+    m_newerBtn->setVisible(on);
+    m_olderBtn->setVisible(on);
+    m_historyPos->setVisible(on);
+    m_historyBtn->setText(on ? "Back" : "History");
+
+    if (on) {
+        showHistoryPage(0);
+    } else {
+        while (QLayoutItem *it = m_historyList->takeAt(0)) {
+            if (it->widget()) it->widget()->deleteLater();
+            delete it;
+        }
+        resizeToItems(m_notificationCount);
+    }
+}
+
+// Newest dismissed first. Only this page's records are read from disk,
+// so paging costs the same at entry 20 as at entry 20000.
+void StatusPanel::showHistoryPage(int page) {
+    while (QLayoutItem *it = m_historyList->takeAt(0)) {
+        if (it->widget()) it->widget()->deleteLater();
+        delete it;
+    }
+
+    int total = m_log.dismissedCount();
+    int pages = qMax(1, (total + HISTORY_PAGE - 1) / HISTORY_PAGE);
+    m_historyPage = qBound(0, page, pages - 1);
+
+    int skip = m_historyPage * HISTORY_PAGE;
+    int shown = 0;
+    const QVector<LogEntry> &all = m_log.entries();
+    for (int i = all.size() - 1; i >= 0 && shown < HISTORY_PAGE; --i) {
+        if (!all[i].dismissed) continue;
+        if (skip > 0) { --skip; continue; }
+
+        NotificationInfo info;
+        if (!m_log.read(all[i], info)) continue;
+        m_historyList->addWidget(historyRow(info));
+        ++shown;
+    }
+
+    if (total == 0) {
+        QLabel *empty = new QLabel("No history", m_history);
+        empty->setStyleSheet("color:#BBBBBB;font-size:22px;");
+        empty->setAlignment(Qt::AlignCenter);
+        m_historyList->addWidget(empty);
+        m_historyPos->clear();
+    } else {
+        int first = m_historyPage * HISTORY_PAGE + 1;
+        m_historyPos->setText(QString("%1–%2 of %3")
+                              .arg(first).arg(first + shown - 1).arg(total));
+    }
+
+    m_newerBtn->setEnabled(m_historyPage > 0);
+    m_olderBtn->setEnabled(m_historyPage < pages - 1);
+
+    resizeToItems(shown);
+}
+
+// compact one-line row: date/time, title, first line of the body
+QWidget *StatusPanel::historyRow(const NotificationInfo &info) {
+    QFrame *row = new QFrame(m_history);
+    row->setStyleSheet("background:#282828;border-radius:14px;border:none;");
+
+    QHBoxLayout *h = new QHBoxLayout(row);
+    h->setContentsMargins(10, 5, 10, 5);
+    h->setSpacing(10);
+
+    QLabel *timeLbl = new QLabel(info.when.toLocalTime().toString("dd MMM\nhh:mm"), row);
+    timeLbl->setFixedWidth(84);
+    timeLbl->setAlignment(Qt::AlignCenter);
+    timeLbl->setStyleSheet("color:#BBBBBB;font-size:18px;");
+
+    QLabel *text = new QLabel(row);
+    text->setTextFormat(Qt::PlainText);
+    text->setStyleSheet("color:#CCCCCC;font-size:20px;");
+    text->ensurePolished();     // so fontMetrics() sees the stylesheet size
+    QString line = info.title;
+    QString body = info.body.section('\n', 0, 0).simplified();
+    if (!body.isEmpty())
+        line += " — " + body;
+    text->setText(text->fontMetrics().elidedText(line, Qt::ElideRight, m_width - 200));
+
+    h->addWidget(timeLbl);
+    h->addWidget(text, 1);
+    return row;
 }
 
 // ───────────────────────────────────────────── NotificationCard impl
 
 NotificationCard::NotificationCard(
     StatusPanel *panel,
-    const NotificationInfo &info,
+    const QString &key,
     QWidget *parent)
-    : QFrame(parent), m_panel(panel), m_info(info)
+    : QFrame(parent), m_panel(panel), m_key(key)
 {
     // auto height: let layout decide; just a small minimum
     setMinimumHeight(60);
@@ -344,10 +1102,7 @@ NotificationCard::NotificationCard(
     h->setSpacing(10);
 
     // TIME LABEL (left side)
-    QLabel *timeLbl = new QLabel(
-        m_info.when.toLocalTime().toString("hh:mm"),
-        this
-    );
+    QLabel *timeLbl = new QLabel(this);
     timeLbl->setFixedWidth(64);
     // Center time vertically & horizontally in its column
     timeLbl->setAlignment(Qt::AlignCenter);
@@ -359,20 +1114,31 @@ NotificationCard::NotificationCard(
     v->setContentsMargins(10,10,10,25);
     v->setSpacing(10);
 
-    QLabel *title = new QLabel(m_info.title, this);
+    // TITLE + repeat counter on one row
+    QHBoxLayout *titleRow = new QHBoxLayout;
+    titleRow->setSpacing(10);
+
+    QLabel *title = new QLabel(this);
     title->setStyleSheet("color:white;font-size:28px;font-weight:bold;");
     title->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     m_titleLabel = title;
-    v->addWidget(title);
-
-    // BODY (2nd line, optional)
-    if (!m_info.body.isEmpty()) {
-        QLabel *body = new QLabel(m_info.body, this);
-        body->setStyleSheet("color:#CCCCCC;font-size:22px;");
-        body->setWordWrap(true);
-        body->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-        v->addWidget(body);
-    }
+    titleRow->addWidget(title, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setStyleSheet(
+        "color:white;background:#00A0DC;border-radius:14px;"
+        "font-size:20px;font-weight:bold;padding:2px 10px;");
+    m_countLabel->hide();
+    titleRow->addWidget(m_countLabel, 0, Qt::AlignVCenter);
+    v->addLayout(titleRow);
+
+    // BODY (2nd line, optional): newest distinct bodies of the group
+    m_bodyLabel = new QLabel(this);
+    m_bodyLabel->setStyleSheet("color:#CCCCCC;font-size:22px;");
+    m_bodyLabel->setWordWrap(true);
+    m_bodyLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    m_bodyLabel->hide();
+    v->addWidget(m_bodyLabel);
 
     // CLOSE BUTTON
     QPushButton *close = new QPushButton(" ❌", this);
@@ -382,6 +1148,8 @@ NotificationCard::NotificationCard(
         "QPushButton:pressed { color:#ffffff; background:#550000; border-radius:18px; }"
     );
 
+    m_timeLabel = timeLbl;
+
     // build layout
     h->addWidget(timeLbl);
     h->addWidget(textBox, 1);   // expands to fit text
@@ -389,10 +1157,27 @@ NotificationCard::NotificationCard(
 
     connect(close, &QPushButton::clicked, [this]() {
         if (m_panel)
-            m_panel->removeNotification(m_info.path);
+            m_panel->removeGroup(m_key);
     });
 }
 
+void NotificationCard::setGroup(const NotificationGroup &g) {
+    m_when = g.when;
+    m_timeLabel->setText(g.when.toLocalTime().toString("hh:mm"));
+    m_titleLabel->setText(g.title);
+
+    int n = g.ids.size();
+    m_countLabel->setText(QString("×%1").arg(n));
+    m_countLabel->setVisible(n > 1);
+
+    QString body = g.bodies.join('\n');
+    int more = g.seenBodies.size() - g.bodies.size();
+    if (more > 0)
+        body += QString("\n+%1 more").arg(more);
+    m_bodyLabel->setText(body);
+    m_bodyLabel->setVisible(!body.isEmpty());
+}
+
 void NotificationCard::mousePressEvent(QMouseEvent *e) {
     if(e->button()==Qt::LeftButton) {
         // could later add “tap to open file” etc; for now do nothing
@@ -582,7 +1367,10 @@ public:
         anim->setEndValue(endGeo);
         anim->setEasingCurve(QEasingCurve::InCubic);
         connect(anim,&QPropertyAnimation::finished,[this](){
-            if (m_panel) m_panel->hide();
+            if (m_panel) {
+                m_panel->hide();
+                m_panel->setHistoryVisible(false);
+            }
             hide();
             if (m_badge)
                 m_badge->setCount(m_panel->notificationCount());
@@ -590,6 +1378,8 @@ public:
         anim->start(QAbstractAnimation::DeleteWhenStopped);
     }
 
+    QWidget *panel() const { return m_panel; }
+
 protected:
     void mousePressEvent(QMouseEvent *e) override {
         if (m_panel && !m_panel->geometry().contains(e->pos()))
@@ -619,87 +1409,6 @@ void NotificationBadge::mousePressEvent(QMouseEvent *e) {
     QWidget::mousePressEvent(e);
 }
 
-// ───────────────────────────────────────────── ActivationEdgeBar
-// Always-on-top, right-side touch bar (mirror of osm-running's left bar)
-
-class ActivationEdgeBar : public QWidget {
-public:
-    explicit ActivationEdgeBar(OverlayRoot *overlay, QWidget *parent = nullptr)
-        : QWidget(parent),
-          m_overlay(overlay),
-          m_dragging(false)
-    {
-        setWindowFlags(Qt::FramelessWindowHint
-                       | Qt::WindowStaysOnTopHint
-                       | Qt::BypassWindowManagerHint
-                       | Qt::WindowDoesNotAcceptFocus);
-        setAttribute(Qt::WA_TranslucentBackground);
-        setAttribute(Qt::WA_NoSystemBackground);
-        setAttribute(Qt::WA_ShowWithoutActivating);
-        setMouseTracking(true);
-
-        QRect g = QGuiApplication::primaryScreen()->geometry();
-        int barWidth = 10;
-        int x = g.x() + g.width() - barWidth;
-        setGeometry(x, g.y(), barWidth, g.height());
-        setStyleSheet("background: rgba(0,0,0,0);");
-
-        show();
-        raise();
-
-        // keep stubbornly on top, like osm-running
-        m_raiseTimer = new QTimer(this);
-        m_raiseTimer->setInterval(1500);
-        connect(m_raiseTimer, &QTimer::timeout, this, [this]() {
-            this->raise();
-        });
-        m_raiseTimer->start();
-    }
-
-protected:
-    void mousePressEvent(QMouseEvent *e) override {
-        if (e->button() == Qt::LeftButton) {
-            m_dragging = true;
-            m_pressPos = e->globalPos();
-            raise();  // assert on top when touched
-        }
-        QWidget::mousePressEvent(e);
-    }
-
-    void mouseMoveEvent(QMouseEvent *e) override {
-        if (!m_dragging) {
-            QWidget::mouseMoveEvent(e);
-            return;
-        }
-
-        // swipe left from the right edge
-        int dx = m_pressPos.x() - e->globalPos().x();
-        if (dx > 12) {
-            if (m_overlay) {
-                m_overlay->showPanel();
-            }
-            m_dragging = false;
-        }
-
-        QWidget::mouseMoveEvent(e);
-    }
-
-    void mouseReleaseEvent(QMouseEvent *e) override {
-        m_dragging = false;
-        QWidget::mouseReleaseEvent(e);
-    }
-
-    void paintEvent(QPaintEvent *) override {
-        // fully invisible
-    }
-
-private:
-    OverlayRoot *m_overlay;
-    bool         m_dragging;
-    QPoint       m_pressPos;
-    QTimer      *m_raiseTimer;
-};
-
 // ───────────────────────────────────────────── main
 
 int main(int argc,char**argv) {
@@ -711,7 +1420,7 @@ int main(int argc,char**argv) {
         return 0;
 
     OverlayRoot root;          // overlay window
-    ActivationEdgeBar bar(&root);   // always-on-top gesture edge
+    EdgeListener edge("osm-status", root.panel(), [&root]() { root.showPanel(); });
 
     return app.exec();
 }
@@ -0,0 +1,191 @@
+// osm-trace: merge the trace rings written by osm-powerd (/run/osm-trace)
+// and osm-power ($XDG_RUNTIME_DIR/osm-trace) into one Chrome trace
+// (chrome://tracing, ui.perfetto.dev).
+//
+//   osm-trace > power.json     dump everything still in the rings
+//   osm-trace --clear          empty the rings (root for osm-powerd's)
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/osmtrace.h"
+
+struct Event {
+    uint64_t ts;
+    uint32_t pid;
+    uint32_t tid;
+    char phase;
+    std::string proc;
+    std::string name;
+    std::string arg;
+};
+
+static std::string jsonEscape(const std::string &s) {
+    std::string out;
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c);
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += char(c);
+        }
+    }
+    return out;
+}
+
+// Copy every complete record out of one ring. A record is taken only if
+// its sequence number is the same before and after the copy, so one
+// being overwritten mid-read is skipped, not torn.
+static bool readRing(const std::string &path, std::vector<Event> &out, bool clear) {
+    int fd = open(path.c_str(), (clear ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < off_t(sizeof(TraceHeader))) {
+        close(fd);
+        return false;
+    }
+    size_t size = size_t(st.st_size);
+    void *p = mmap(nullptr, size, clear ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(path.c_str());
+        return false;
+    }
+
+    TraceHeader *h = static_cast<TraceHeader *>(p);
+    if (h->magic != TRACE_MAGIC || h->version != TRACE_VERSION ||
+        h->recordSize != sizeof(TraceRecord) ||
+        sizeof(TraceHeader) + size_t(h->capacity) * sizeof(TraceRecord) > size) {
+        std::cerr << "osm-trace: " << path << ": not a trace ring\n";
+        munmap(p, size);
+        return false;
+    }
+
+    TraceRecord *ring = reinterpret_cast<TraceRecord *>(h + 1);
+    uint64_t cap = h->capacity;
+
+    if (clear) {
+        for (uint64_t i = 0; i < cap; ++i)
+            ring[i].seq.store(0, std::memory_order_relaxed);
+        h->head.store(0, std::memory_order_release);
+        munmap(p, size);
+        return true;
+    }
+
+    uint64_t head = h->head.load(std::memory_order_acquire);
+    uint64_t first = head > cap ? head - cap : 0;
+
+    for (uint64_t idx = first; idx < head; ++idx) {
+        const TraceRecord &r = ring[idx % cap];
+        if (r.seq.load(std::memory_order_acquire) != idx + 1)
+            continue;
+
+        Event e;
+        e.ts = r.ts;
+        e.pid = r.pid;
+        e.tid = r.tid;
+        e.phase = r.phase;
+        e.proc.assign(r.proc, strnlen(r.proc, sizeof(r.proc)));
+        e.name.assign(r.name, strnlen(r.name, sizeof(r.name)));
+        e.arg.assign(r.arg, strnlen(r.arg, sizeof(r.arg)));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (r.seq.load(std::memory_order_relaxed) != idx + 1)
+            continue;
+        out.push_back(e);
+    }
+
+    munmap(p, size);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool clear = (argc > 1 && strcmp(argv[1], "--clear") == 0);
+
+    std::vector<std::string> dirs = { "/run/osm-trace" };
+    const char *rt = getenv("XDG_RUNTIME_DIR");
+    dirs.push_back((rt && *rt) ? std::string(rt) + "/osm-trace"
+                               : "/run/user/" + std::to_string(getuid()) + "/osm-trace");
+
+    std::vector<std::string> rings;
+    for (const auto &d : dirs) {
+        DIR *dir = opendir(d.c_str());
+        if (!dir) continue;
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            if (ent->d_name[0] != '.')
+                rings.push_back(d + "/" + ent->d_name);
+        }
+        closedir(dir);
+    }
+
+    if (rings.empty()) {
+        std::cerr << "osm-trace: no trace rings found (nothing traced yet)\n";
+        return 1;
+    }
+
+    std::vector<Event> events;
+    for (const auto &path : rings)
+        readRing(path, events, clear);
+
+    if (clear)
+        return 0;
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event &a, const Event &b) { return a.ts < b.ts; });
+
+    // process names for the trace viewer's track labels
+    std::map<uint32_t, std::string> procs;
+    for (const auto &e : events)
+        procs[e.pid] = e.proc;
+
+    std::cout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstOut = true;
+    auto sep = [&]() {
+        if (!firstOut) std::cout << ",\n";
+        firstOut = false;
+    };
+
+    for (const auto &p : procs) {
+        sep();
+        std::cout << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << p.first
+                  << ",\"args\":{\"name\":\"" << jsonEscape(p.second) << "\"}}";
+    }
+
+    for (const auto &e : events) {
+        char ts[32];
+        snprintf(ts, sizeof(ts), "%.3f", double(e.ts) / 1000.0);   // µs
+
+        sep();
+        std::cout << "{\"ph\":\"" << e.phase << "\",\"name\":\"" << jsonEscape(e.name)
+                  << "\",\"ts\":" << ts << ",\"pid\":" << e.pid << ",\"tid\":" << e.tid;
+        if (e.phase == 'i')
+            std::cout << ",\"s\":\"g\"";   // instants span all tracks
+        if (!e.arg.empty())
+            std::cout << ",\"args\":{\"detail\":\"" << jsonEscape(e.arg) << "\"}";
+        std::cout << "}";
+    }
+
+    std::cout << "\n]}\n";
+    return 0;
+}
@@ -69,7 +69,11 @@ def autostart():
     subprocess.Popen(['osm-running'])
     subprocess.Popen(['onboard'])
     subprocess.Popen(['picom', '-b'])
+    subprocess.Popen(['osm-power', '--daemon'])
     subprocess.Popen(['osm-powerd'])
+    subprocess.Popen(['osm-gpiod'])
+    subprocess.Popen(['osm-lmkd'])
+    subprocess.Popen(['osm-edged'])
     subprocess.Popen(['touchegg'])
     # subprocess.Popen(['flameshot'])
     # subprocess.Popen(['redshift'])
@@ -152,9 +156,7 @@ keys = [
     Key([mod, "control"], "q", lazy.shutdown(), desc="Shutdown Qtile"),
     Key([mod], "r", lazy.spawncmd(), desc="Spawn a command using a prompt widget"),
 
-    Key([], "XF86AudioRaiseVolume", lazy.spawn("amixer -q set Master 5%+")),
-    Key([], "XF86AudioLowerVolume", lazy.spawn("amixer -q set Master 5%-")),
-    Key([], "XF86AudioMute", lazy.spawn("amixer -q set Master toggle")),
+    # volume and brightness keys are handled by osm-powerd
 ]
 
 # Add key bindings to switch VTs in Wayland.
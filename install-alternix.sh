@@ -137,11 +137,11 @@ sudo nala install xlibre -y
 echo "[System] Installing Required Components.."
 sudo nala install -y \
     fastfetch qtile qtbase5-dev qt5-qmake qtbase5-dev-tools qtdeclarative5-dev \
-    fonts-noto-color-emoji libxcomposite-dev libxrender-dev libxfixes-dev \
+    fonts-noto-color-emoji libxcomposite-dev libxdamage-dev libxcb1-dev libxi-dev libxrender-dev libxfixes-dev qt5-image-formats-plugins \
     xwallpaper pkg-config libpoppler-qt5-dev htop python3-pip curl git fuse\
     python3-venv picom redshift onboard samba xdotool alacritty aria2 sqlite3\
     synaptic brightnessctl pavucontrol pulseaudio alsa-utils flatpak libevdev-dev\
-    snapd power-profiles-daemon xprintidle libx11-dev libxtst-dev ntfs-3g \
+    snapd power-profiles-daemon xprintidle libx11-dev libxtst-dev libxrandr-dev libxres-dev ntfs-3g ffmpeg \
     kalk vlc qt5-style-kvantum network-manager libpolkit-agent-1-dev \
     libpolkit-gobject-1-dev peazip aptitude timeshift xdg-utils python3-lxml\
     python3-yaml python3-dateutil python3-pyqt5 python3-packaging python3-request
@@ -365,19 +365,19 @@ chmod +x osm-lock && sudo mv osm-lock /usr/local/bin/
 
 
 echo "• Building osm-running..."
-g++ apps/osm-running.cpp -o osm-running -fPIC -ldl $(pkg-config --cflags --libs Qt5Widgets) -lX11
+g++ apps/osm-running.cpp -o osm-running -fPIC -ldl $(pkg-config --cflags --libs Qt5Widgets Qt5Network) -lX11 -lX11-xcb -lxcb -lXext -lXcomposite -lXdamage
 chmod +x osm-running && sudo mv osm-running /usr/local/bin/
 
 
 
 echo "• Building osm-notify..."
-g++ -fPIC apps/osm-notify.cpp -o osm-notify $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core Qt5DBus) -lX11 -lXtst
+g++ -fPIC apps/osm-notify.cpp -o osm-notify $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core Qt5DBus Qt5Network) -lX11 -lXtst -lXrandr
 chmod +x osm-notify && sudo mv osm-notify /usr/local/bin/
 
 
 
 echo "• Building osm-status..."
-g++ apps/osm-status.cpp -o osm-status -fPIC -ldl $(pkg-config --cflags --libs Qt5Widgets) -lX11
+g++ apps/osm-status.cpp -o osm-status -fPIC -ldl $(pkg-config --cflags --libs Qt5Widgets Qt5Network) -lX11
 chmod +x osm-status && sudo mv osm-status /usr/local/bin/
 
 
@@ -514,7 +514,7 @@ chmod +x "$HOME/.local/share/applications/osm-draw.desktop"
 
 
 echo "• Building osm-rocker..."
-g++ -fPIC apps/osm-rocker.cpp -o osm-rocker $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core)
+g++ -fPIC apps/osm-rocker.cpp -o osm-rocker $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core Qt5Network) -lX11 -lXext -lXdamage
 chmod +x osm-rocker && sudo mv osm-rocker /usr/local/bin/
 
 
@@ -533,7 +533,7 @@ sudo chmod 755 /usr/local/bin/osm-sudo
 
 
 echo "• Building osm-power..."
-g++ -fPIC apps/osm-power.cpp -o osm-power $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core)
+g++ -fPIC apps/osm-power.cpp -o osm-power $(pkg-config --cflags --libs Qt5Widgets Qt5Gui Qt5Core Qt5Network Qt5DBus)
 chmod +x osm-power && sudo mv osm-power /usr/local/bin/
 
 
@@ -544,6 +544,40 @@ sudo chmod +x osm-powerd && sudo mv osm-powerd /usr/local/bin/
 sudo chown root:root /usr/local/bin/osm-powerd
 sudo chmod 4755 /usr/local/bin/osm-powerd
 
+echo "• Compiling osm-gpiod..."
+g++ -O2 apps/osm-gpiod.cpp -o osm-gpiod
+chmod +x osm-gpiod && sudo mv osm-gpiod /usr/local/bin/
+
+# osm-gpiod runs as the user: the GPIO chips and uinput go to groups instead
+sudo groupadd -f --system gpio
+sudo groupadd -f --system uinput
+sudo usermod -aG gpio,uinput "$TARGET_USER"
+sudo tee /etc/udev/rules.d/60-alternix-gpio.rules >/dev/null <<'EOF'
+SUBSYSTEM=="gpio", KERNEL=="gpiochip*", GROUP="gpio", MODE="0660"
+KERNEL=="uinput", SUBSYSTEM=="misc", GROUP="uinput", MODE="0660", OPTIONS+="static_node=uinput"
+EOF
+echo uinput | sudo tee /etc/modules-load.d/uinput.conf >/dev/null
+sudo udevadm control --reload-rules
+sudo udevadm trigger --subsystem-match=gpio --subsystem-match=misc
+
+echo "• Compiling osm-trace..."
+g++ -O2 apps/osm-trace.cpp -o osm-trace
+chmod +x osm-trace && sudo mv osm-trace /usr/local/bin/
+
+
+
+echo "• Compiling osm-lmkd..."
+g++ -O2 apps/osm-lmkd.cpp -o osm-lmkd -lX11 -lXRes
+chmod +x osm-lmkd && sudo mv osm-lmkd /usr/local/bin/
+
+echo "• Compiling osm-record..."
+g++ -O2 apps/osm-record.cpp -o osm-record -pthread -lX11 -lXext -lXdamage -lXfixes
+chmod +x osm-record && sudo mv osm-record /usr/local/bin/
+
+echo "• Compiling osm-edged..."
+g++ -O2 apps/osm-edged.cpp -o osm-edged -lX11 -lXi
+chmod +x osm-edged && sudo mv osm-edged /usr/local/bin/
+
 
 
 